@@ -137,6 +137,17 @@ float AIController::distanceToCentreOfPipeGap(Pipe* pipe, Bird* bird)
 	return distance - bird->GetSprite().getPosition().y;
 }
 
+void AIController::gatherInputs(Bird* p_bird, float* inputs)
+{
+	if (m_pGameState == nullptr)
+		return;
+
+	Pipe* pipe = m_pGameState->GetPipeContainer();
+	Land* land = m_pGameState->GetLandContainer();
+
+	p_bird->GetNetworkInputs(distanceToNearestPipes(pipe, p_bird), distanceToCentreOfPipeGap(pipe, p_bird), distanceToFloor(land, p_bird), distanceToTop(p_bird), inputs);
+}
+
 // note when this is called, it resets the flap state (don't edit)
 bool AIController::shouldFlap() 
 {
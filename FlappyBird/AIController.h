@@ -13,6 +13,7 @@ public:
 	void setGameState(GameState* pGameState) { m_pGameState = pGameState; }
 	void update(Bird* p_bird);
 	bool shouldFlap(); // note when this is called, it resets the flap state
+	void gatherInputs(Bird* p_bird, float* inputs); // writes the normalized network inputs, used by batched inference
 
 public:
 
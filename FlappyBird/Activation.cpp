@@ -0,0 +1,50 @@
+#include "Activation.h"
+
+//Points compared against std::tanh per table segment
+#define ACTIVATION_ERROR_SAMPLES_PER_SEGMENT 16
+
+namespace
+{
+	const char* activationNames[eActivationTypeCount] = { "Tanh", "TanhTable", "TanhRational", "HardTanh", "ReLU" };
+}
+
+int Activation::selected = eActivationTanh;
+float Activation::table[ACTIVATION_TABLE_SEGMENTS + 1];
+const float Activation::tableScale = ACTIVATION_TABLE_SEGMENTS / (2.0f * ACTIVATION_TABLE_RANGE);
+bool Activation::tableBuilt = Activation::BuildTable();
+
+bool Activation::BuildTable()
+{
+	for (int i = 0; i <= ACTIVATION_TABLE_SEGMENTS; i++)
+		table[i] = (float)std::tanh(-ACTIVATION_TABLE_RANGE + i * (2.0 * ACTIVATION_TABLE_RANGE / ACTIVATION_TABLE_SEGMENTS));
+	return true;
+}
+
+const char* Activation::GetName(int type)
+{
+	if (type < 0 || type >= eActivationTypeCount)
+		return "Unknown";
+	return activationNames[type];
+}
+
+int Activation::ParseType(const std::string& name)
+{
+	for (int i = 0; i < eActivationTypeCount; i++)
+	{
+		if (name == activationNames[i])
+			return i;
+	}
+	return -1;
+}
+
+float Activation::GetMaxError(int type)
+{
+	int samples = ACTIVATION_TABLE_SEGMENTS * ACTIVATION_ERROR_SAMPLES_PER_SEGMENT;
+	float maxError = 0.0f;
+	for (int i = 0; i <= samples; i++)
+	{
+		float x = -ACTIVATION_TABLE_RANGE + i * (2.0f * ACTIVATION_TABLE_RANGE / samples);
+		maxError = std::max(maxError, std::abs(Apply(type, x) - std::tanh(x)));
+	}
+	return maxError;
+}
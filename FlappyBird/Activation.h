@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "DEFINITIONS.hpp"
+
+enum ActivationTypes
+{
+	eActivationTanh,
+	eActivationTanhTable,
+	eActivationTanhRational,
+	eActivationHardTanh,
+	eActivationReLU,
+	eActivationTypeCount
+};
+
+//The hidden node activation of every network implementation, the nodes, the compiled and NEAT networks and the
+//quantized population. It's picked once per run, before any network is evaluated
+class Activation
+{
+public:
+	static void Select(int type) { selected = type; }
+	static int GetSelected() { return selected; }
+
+	//Config name of a type, and back. ParseType returns -1 for an unknown name
+	static const char* GetName(int type);
+	static int ParseType(const std::string& name);
+
+	static float Apply(float x) { return Apply(selected, x); }
+	static float Apply(int type, float x)
+	{
+		switch (type)
+		{
+		case eActivationTanhTable:
+			return TanhTable(x);
+		case eActivationTanhRational:
+			return TanhRational(x);
+		case eActivationHardTanh:
+			return HardTanh(x);
+		case eActivationReLU:
+			return ReLU(x);
+		default:
+			return std::tanh(x);
+		}
+	}
+
+	//tanh interpolated linearly between samples, clamped to the ends of the table outside its range
+	static float TanhTable(float x)
+	{
+		float position = (std::min(std::max(x, -ACTIVATION_TABLE_RANGE), ACTIVATION_TABLE_RANGE) + ACTIVATION_TABLE_RANGE) * tableScale;
+		int segment = std::min((int)position, ACTIVATION_TABLE_SEGMENTS - 1);
+		float fraction = position - segment;
+		return table[segment] + fraction * (table[segment + 1] - table[segment]);
+	}
+	//Lambert's continued fraction cut after the x^7 term, within 1e-4 of tanh and clamped to +-1 past ~4.97
+	static float TanhRational(float x)
+	{
+		float x2 = x * x;
+		float numerator = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+		float denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+		return std::min(std::max(numerator / denominator, -1.0f), 1.0f);
+	}
+	static float HardTanh(float x) { return std::min(std::max(x, -1.0f), 1.0f); }
+	static float ReLU(float x) { return std::max(x, 0.0f); }
+
+	//Largest difference from std::tanh over the table range, sampled much finer than the table
+	static float GetMaxError(int type);
+
+private:
+	//Fills the table during static initialisation, nothing evaluates a network before main
+	static bool BuildTable();
+
+	static int selected;
+	static float table[ACTIVATION_TABLE_SEGMENTS + 1];
+	static const float tableScale;
+	static bool tableBuilt;
+};
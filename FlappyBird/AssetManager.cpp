@@ -3,33 +3,91 @@
 
 namespace Sonar
 {
-	void AssetManager::LoadTexture(std::string name, std::string fileName)
+	AssetManager::~AssetManager()
 	{
-		sf::Texture tex;
+		if (_preloadThread.joinable())
+			_preloadThread.join();
+	}
 
-		if (tex.loadFromFile(fileName))
+	void AssetManager::Preload(const std::vector<std::pair<std::string, std::string>>& manifest)
+	{
+		FinishPreload();
+		_manifest.clear();
+		for (const auto& entry : manifest)
 		{
-			this->_textures[name] = tex;
+			if (_textures.find(entry.first) == _textures.end())
+				_manifest.push_back(entry);
 		}
+		_preloadedImages.assign(_manifest.size(), sf::Image());
+
+		//Reading and decoding the files is the slow part and needs no OpenGL context, the upload stays on this thread
+		_preloadThread = std::thread([this]() {
+			for (int i = 0; i < (int)_manifest.size(); i++)
+			{
+				_preloadedImages.at(i).loadFromFile(_manifest.at(i).second);
+			}
+		});
 	}
 
-	sf::Texture &AssetManager::GetTexture(std::string name)
+	void AssetManager::FinishPreload()
 	{
-		return this->_textures.at(name);
+		if (!_preloadThread.joinable())
+			return;
+		_preloadThread.join();
+
+		for (int i = 0; i < (int)_manifest.size(); i++)
+		{
+			const std::string& name = _manifest.at(i).first;
+			const std::string& fileName = _manifest.at(i).second;
+			if (_textureFiles.find(fileName) == _textureFiles.end())
+			{
+				//Files that failed to decode are left for LoadTexture to try again
+				if (_preloadedImages.at(i).getSize().x == 0 || !_textureFiles[fileName].loadFromImage(_preloadedImages.at(i)))
+				{
+					_textureFiles.erase(fileName);
+					continue;
+				}
+			}
+			_textures.emplace(name, &_textureFiles.find(fileName)->second);
+		}
+		_manifest.clear();
+		_preloadedImages.clear();
 	}
 
-	void AssetManager::LoadFont(std::string name, std::string fileName)
+	void AssetManager::LoadTexture(const std::string& name, const std::string& fileName)
 	{
-		sf::Font font;
+		FinishPreload();
+		if (this->_textures.find(name) != this->_textures.end())
+			return;
 
-		if (font.loadFromFile(fileName))
+		auto file = this->_textureFiles.find(fileName);
+		if (file == this->_textureFiles.end())
 		{
-			this->_fonts[name] = font;
+			file = this->_textureFiles.emplace(fileName, sf::Texture()).first;
+			if (!file->second.loadFromFile(fileName))
+			{
+				this->_textureFiles.erase(file);
+				return;
+			}
 		}
+		this->_textures[name] = &file->second;
 	}
 
-	sf::Font &AssetManager::GetFont(std::string name)
+	void AssetManager::LoadFont(const std::string& name, const std::string& fileName)
 	{
-		return this->_fonts.at(name);
+		if (this->_fonts.find(name) != this->_fonts.end())
+			return;
+
+		auto file = this->_fontFiles.find(fileName);
+		if (file == this->_fontFiles.end())
+		{
+			file = this->_fontFiles.emplace(fileName, sf::Font()).first;
+			if (!file->second.loadFromFile(fileName))
+			{
+				this->_fontFiles.erase(file);
+				return;
+			}
+		}
+		this->_fonts[name] = &file->second;
 	}
-}
\ No newline at end of file
+}
@@ -1,24 +1,58 @@
 #pragma once
 
+#include <functional>
 #include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <SFML/Graphics.hpp>
 
 namespace Sonar
 {
+	//Assets stay loaded for the whole run, so states that are created every generation only look them up.
+	//Lookups take the name as it is written, without building a std::string
 	class AssetManager
 	{
 	public:
 		AssetManager() { }
-		~AssetManager() { }
+		~AssetManager();
 
-		void LoadTexture(std::string name, std::string fileName);
-		sf::Texture &GetTexture(std::string name);
+		//Decodes the images of these name and file pairs on a background thread. The first load after it finishes uploads them
+		void Preload(const std::vector<std::pair<std::string, std::string>>& manifest);
 
-		void LoadFont(std::string name, std::string fileName);
-		sf::Font &GetFont(std::string name);
+		//Names that are already loaded are skipped, and a file loaded under another name is shared rather than read again
+		void LoadTexture(const std::string& name, const std::string& fileName);
+		template <typename Name>
+		sf::Texture &GetTexture(const Name& name) { return *Find(_textures, name); }
+
+		void LoadFont(const std::string& name, const std::string& fileName);
+		template <typename Name>
+		sf::Font &GetFont(const Name& name) { return *Find(_fonts, name); }
 
 	private:
-		std::map<std::string, sf::Texture> _textures;
-		std::map<std::string, sf::Font> _fonts;
+		//Waits for the preload thread and turns what it decoded into textures
+		void FinishPreload();
+
+		template <typename Asset, typename Name>
+		static Asset* Find(const std::map<std::string, Asset*, std::less<>>& assets, const Name& name)
+		{
+			auto asset = assets.find(name);
+			if (asset == assets.end())
+				throw std::out_of_range(std::string("Asset not loaded: ") + name);
+			return asset->second;
+		}
+
+		//Loaded assets by file. The names point into these, std::map never moves its values
+		std::map<std::string, sf::Texture, std::less<>> _textureFiles;
+		std::map<std::string, sf::Font, std::less<>> _fontFiles;
+		std::map<std::string, sf::Texture*, std::less<>> _textures;
+		std::map<std::string, sf::Font*, std::less<>> _fonts;
+
+		std::thread _preloadThread;
+		std::vector<std::pair<std::string, std::string>> _manifest;
+		//One per manifest entry, only touched by the preload thread until it is joined
+		std::vector<sf::Image> _preloadedImages;
 	};
 }
@@ -0,0 +1,307 @@
+#include "Benchmark.hpp"
+#include "GameState.hpp"
+#include "AIController.h"
+#include "Process.hpp"
+#include "Activation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+#define BENCHMARK_SEED 12345
+#define BENCHMARK_SAMPLES 9
+//Pipe columns on screen in the fixture
+#define BENCHMARK_PIPE_COLUMNS 3
+//Pre-activations each activation benchmark call runs through
+#define BENCHMARK_ACTIVATION_VALUES 4096
+
+namespace Sonar
+{
+	Benchmark::Benchmark(const RunConfig& config)
+	{
+		_data->config = config;
+		Activation::Select(Activation::ParseType(_data->config.activation));
+	}
+
+	bool Benchmark::Run(const std::string& outputFileName)
+	{
+		std::string epochFileName = FindEpoch();
+		std::ifstream epochFile(epochFileName);
+		if (!epochFile.good())
+		{
+			std::cout << "Error Loading Benchmark Epoch " << epochFileName << std::endl;
+			return false;
+		}
+		std::stringstream epochText;
+		epochText << epochFile.rdbuf();
+		json populationData = json::parse(epochText.str(), nullptr, false);
+		if (populationData.is_discarded())
+		{
+			std::cout << "Error Reading Benchmark Epoch " << epochFileName << std::endl;
+			return false;
+		}
+
+		//Textures need a context, the window itself is never shown
+		_data->window.create(sf::VideoMode(SCREEN_WIDTH, SCREEN_HEIGHT), "Flappy Bird Benchmark", sf::Style::Close | sf::Style::Titlebar);
+		_data->window.setVisible(false);
+
+		GameState state(_data);
+		state.LoadAssets();
+		state.pipe = new Pipe(_data);
+		state.land = new Land(_data);
+
+		srand(BENCHMARK_SEED);
+		state.ImportBirds(_data, populationData, _data->config.populationSize);
+		if (_data->config.compiledNetworks)
+		{
+			for (auto bird : state.birds)
+			{
+				bird->CompileNetwork();
+			}
+		}
+		BuildCourse(state);
+
+		std::vector<Bird*>& birds = state.birds;
+		std::vector<float> inputs(birds.size() * NETWORK_INPUTS);
+		for (int i = 0; i < (int)birds.size(); i++)
+		{
+			state.m_pAIController->gatherInputs(birds.at(i), &inputs.at(i * NETWORK_INPUTS));
+		}
+		int population = (int)birds.size();
+
+		std::cout << "Benchmarking " << population << " birds from " << epochFileName << std::endl;
+
+		//Forward pass
+		Measure("ForwardPass/Bird", 20000, 1, [&]() {
+			_sink += birds.at(0)->FindShouldFlap(inputs.data());
+		});
+		Measure("ForwardPass/Population", 100, 1, [&]() {
+			for (int i = 0; i < population; i++)
+			{
+				_sink += birds.at(i)->FindShouldFlap(&inputs.at(i * NETWORK_INPUTS));
+			}
+		});
+		if (_data->config.inferenceMode != INFERENCE_FLOAT)
+		{
+			QuantizedPopulation quantizedPopulation(_data->config.inferenceMode == INFERENCE_INT8 ? eQuantizeInt8 : eQuantizeFloat16);
+			for (auto bird : birds)
+			{
+				quantizedPopulation.AddNetwork(bird->nodeNetwork);
+			}
+			std::vector<int> networkIndices(population);
+			std::iota(networkIndices.begin(), networkIndices.end(), 0);
+			std::vector<unsigned char> decisions(population);
+			Measure("ForwardPass/PopulationQuantized", 100, 1, [&]() {
+				quantizedPopulation.Evaluate(networkIndices.data(), population, inputs.data(), decisions.data());
+				_sink += decisions.at(0);
+			});
+		}
+
+		//Every activation on the same pre-activations, with its largest difference from tanh
+		std::vector<float> preActivations(BENCHMARK_ACTIVATION_VALUES);
+		for (int i = 0; i < BENCHMARK_ACTIVATION_VALUES; i++)
+		{
+			preActivations.at(i) = -ACTIVATION_TABLE_RANGE + i * (2.0f * ACTIVATION_TABLE_RANGE / BENCHMARK_ACTIVATION_VALUES);
+		}
+		for (int type = 0; type < eActivationTypeCount; type++)
+		{
+			Measure(std::string("Activation/") + Activation::GetName(type), 100, BENCHMARK_ACTIVATION_VALUES, [&]() {
+				float sum = 0;
+				for (float value : preActivations)
+				{
+					sum += Activation::Apply(type, value);
+				}
+				_sink += (int)sum;
+			});
+			_results.back()["MaxError"] = Activation::GetMaxError(type);
+			std::cout << "    max error against tanh " << Activation::GetMaxError(type) << std::endl;
+		}
+
+		//Sensors
+		Measure("Sensors/GatherInputs", 20, population, [&]() {
+			for (int i = 0; i < population; i++)
+			{
+				state.m_pAIController->gatherInputs(birds.at(i), &inputs.at(i * NETWORK_INPUTS));
+			}
+		});
+
+		//Collision, one bird against every pipe on screen
+		const std::vector<sf::Sprite>& pipeSprites = state.pipe->GetSprites();
+		Measure("Collision/CheckSpriteCollision", 2000, (int)pipeSprites.size(), [&]() {
+			for (unsigned int i = 0; i < pipeSprites.size(); i++)
+			{
+				_sink += state.collision.CheckSpriteCollision(birds.at(0)->GetSprite(), 0.625f, pipeSprites.at(i), 1.0f, false);
+			}
+		});
+
+		//Moving back keeps the course the same for every iteration
+		Measure("Pipe/MovePipes", 10000, 2, [&]() {
+			state.pipe->MovePipes(1.0f / 60.0f);
+			state.pipe->MovePipes(-1.0f / 60.0f);
+		});
+
+		//Genetic algorithm
+		MeasureWithSetup("GeneticAlgorithm/Evolve", 1, [&]() {
+			ClearBirds(state);
+			srand(BENCHMARK_SEED);
+			state.ImportBirds(_data, populationData, _data->config.populationSize);
+		}, [&]() {
+			state.Evolve(_data);
+		});
+		Measure("GeneticAlgorithm/Crossover", 200, 1, [&]() {
+			Bird* child = state.Crossover(_data, birds.at(0), birds.at(1));
+			_sink += child->score;
+			delete child;
+		});
+
+		//Epoch files
+		Measure("Epoch/Parse", 3, 1, [&]() {
+			_sink += (int)json::parse(epochText.str()).size();
+		});
+		MeasureWithSetup("Epoch/ImportBirds", 1, [&]() {
+			ClearBirds(state);
+		}, [&]() {
+			state.ImportBirds(_data, populationData, _data->config.populationSize);
+		});
+		//Keep the exported files out of the epoch directory the game scans
+		_data->config.epochDirectory += "benchmark/";
+		CreateDirectories(_data->config.epochDirectory);
+		state.generationNumber = 0;
+		Measure("Epoch/ExportBirds", 1, 1, [&]() {
+			state.ExportBirds();
+		});
+
+		ClearBirds(state);
+
+		nlohmann::json output;
+		output["Fixture"] = epochFileName;
+		output["PopulationSize"] = population;
+		output["Config"] = _data->config.ToJson();
+		output["Samples"] = BENCHMARK_SAMPLES;
+		output["Results"] = _results;
+
+		std::ofstream outputFile(outputFileName);
+		if (!outputFile.good())
+		{
+			std::cout << "Error Writing Benchmark Results " << outputFileName << std::endl;
+			return false;
+		}
+		outputFile << std::setw(4) << output << std::endl;
+		std::cout << "Benchmark results written to " << outputFileName << std::endl;
+		return true;
+	}
+
+	void Benchmark::Measure(const std::string& name, int iterations, int items, const std::function<void()>& function)
+	{
+		//Warm up the caches and any lazy allocation
+		function();
+
+		std::vector<double> samples;
+		for (int sample = 0; sample < BENCHMARK_SAMPLES; sample++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				function();
+			}
+			auto end = std::chrono::steady_clock::now();
+			samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+		}
+		AddResult(name, items, samples);
+	}
+
+	void Benchmark::MeasureWithSetup(const std::string& name, int items, const std::function<void()>& setup, const std::function<void()>& function)
+	{
+		std::vector<double> samples;
+		for (int sample = 0; sample < BENCHMARK_SAMPLES; sample++)
+		{
+			setup();
+			auto start = std::chrono::steady_clock::now();
+			function();
+			auto end = std::chrono::steady_clock::now();
+			samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+		}
+		AddResult(name, items, samples);
+	}
+
+	void Benchmark::AddResult(const std::string& name, int items, std::vector<double> samples)
+	{
+		//Per item times, the median is what gets compared between runs
+		items = std::max(1, items);
+		for (auto& sample : samples)
+		{
+			sample /= items;
+		}
+		std::sort(samples.begin(), samples.end());
+		double median = samples.at(samples.size() / 2);
+
+		nlohmann::json result;
+		result["Name"] = name;
+		result["ItemsPerCall"] = items;
+		result["MedianNs"] = median;
+		result["MinNs"] = samples.front();
+		result["MaxNs"] = samples.back();
+		result["ItemsPerSecond"] = median > 0 ? 1e9 / median : 0;
+		_results.push_back(result);
+
+		//Formatted on its own stream so std::cout keeps its precision
+		std::ostringstream line;
+		line << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(14) << median << " ns" << std::setw(14) << samples.front() << " ns min";
+		std::cout << line.str() << std::endl;
+	}
+
+	void Benchmark::BuildCourse(GameState& state)
+	{
+		//Columns one spawn interval apart, the same layout the game reaches after a few seconds
+		for (int column = 0; column < BENCHMARK_PIPE_COLUMNS; column++)
+		{
+			state.pipe->RandomisePipeOffset();
+			state.pipe->SpawnInvisiblePipe();
+			state.pipe->SpawnBottomPipe();
+			state.pipe->SpawnTopPipe();
+			state.pipe->SpawnScoringPipe();
+			if (column < BENCHMARK_PIPE_COLUMNS - 1)
+				state.pipe->MovePipes(PIPE_SPAWN_FREQUENCY / GAME_SPEED);
+		}
+
+		//Spread the birds over different heights
+		for (int i = 0; i < (int)state.birds.size(); i++)
+		{
+			for (int tick = 0; tick < i % 40; tick++)
+			{
+				if (tick % 10 == 0)
+					state.birds.at(i)->Tap();
+				state.birds.at(i)->Update(1.0f / 60.0f);
+			}
+		}
+	}
+
+	void Benchmark::ClearBirds(GameState& state)
+	{
+		for (auto bird : state.birds)
+		{
+			delete bird;
+		}
+		state.birds.clear();
+	}
+
+	std::string Benchmark::FindEpoch() const
+	{
+		if (!_data->config.benchmarkEpoch.empty())
+			return _data->config.benchmarkEpoch;
+
+		//Newest epoch in the epoch directory, the same scan GameState::Init does
+		std::string epochDirectory = _data->config.epochDirectory;
+		int generation = -1;
+		while (FileExists(epochDirectory + "epoch" + std::to_string(generation + 1) + ".json"))
+		{
+			generation++;
+		}
+		return epochDirectory + "epoch" + std::to_string(std::max(generation, 0)) + ".json";
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Game.hpp"
+
+namespace Sonar
+{
+	class GameState;
+
+	//Times the training hot paths on fixtures built from a saved epoch, and writes the results to a json file
+	//so runs can be compared across commits. The fixtures are seeded, every run measures the same work
+	class Benchmark
+	{
+	public:
+		Benchmark(const RunConfig& config);
+
+		//Returns false if the fixture epoch can't be loaded
+		bool Run(const std::string& outputFileName);
+
+	private:
+		//Calls function iterations times per sample, items is the work done by one call
+		void Measure(const std::string& name, int iterations, int items, const std::function<void()>& function);
+		//Calls setup then times one call of function per sample
+		void MeasureWithSetup(const std::string& name, int items, const std::function<void()>& setup, const std::function<void()>& function);
+		void AddResult(const std::string& name, int items, std::vector<double> samples);
+
+		//Builds the pipes and moves the birds apart, so the sensors and networks see varied inputs
+		void BuildCourse(GameState& state);
+		void ClearBirds(GameState& state);
+		std::string FindEpoch() const;
+
+		GameDataRef _data = std::make_shared<GameData>();
+
+		nlohmann::json _results = nlohmann::json::array();
+		//Written by the timed functions so the work can't be optimised away
+		volatile int _sink = 0;
+	};
+}
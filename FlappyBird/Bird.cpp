@@ -1,19 +1,34 @@
 #include "Bird.hpp"
+#include "GenomeHash.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace Sonar
 {
 	Bird::Bird(GameDataRef data, std::vector<std::vector<Node*>> p_nodeNetwork) : _data(data)
 	{
 		nodeNetwork = std::vector<std::vector<Node*>>(p_nodeNetwork);
+		InitSprite();
+	}
+
+	Bird::Bird(GameDataRef data, const NeatGenome& p_genome) : _data(data)
+	{
+		genome = new NeatGenome(p_genome);
+		compiledNetwork = new NeatNetwork(*genome);
+		InitSprite();
+	}
 
+	void Bird::InitSprite()
+	{
 		_animationIterator = 0;
 
-		_animationFrames.push_back(this->_data->assets.GetTexture("Bird Frame 1"));
-		_animationFrames.push_back(this->_data->assets.GetTexture("Bird Frame 2"));
-		_animationFrames.push_back(this->_data->assets.GetTexture("Bird Frame 3"));
-		_animationFrames.push_back(this->_data->assets.GetTexture("Bird Frame 4"));
+		_animationFrames.push_back(&this->_data->assets.GetTexture("Bird Frame 1"));
+		_animationFrames.push_back(&this->_data->assets.GetTexture("Bird Frame 2"));
+		_animationFrames.push_back(&this->_data->assets.GetTexture("Bird Frame 3"));
+		_animationFrames.push_back(&this->_data->assets.GetTexture("Bird Frame 4"));
 
-		_birdSprite.setTexture(_animationFrames.at(_animationIterator));
+		_birdSprite.setTexture(*_animationFrames.at(_animationIterator));
 
 		_birdSprite.setPosition((_data->window.getSize().x / 4) - (_birdSprite.getGlobalBounds().width / 2), (_data->window.getSize().y / 2) - (_birdSprite.getGlobalBounds().height / 2));
 	
@@ -28,6 +43,10 @@ namespace Sonar
 
 	Bird::~Bird()
 	{
+		if (compiledNetwork != nullptr)
+			delete compiledNetwork;
+		if (genome != nullptr)
+			delete genome;
 		for (std::vector<Node*> layer : nodeNetwork)
 		{
 			for (Node* node : layer)
@@ -46,7 +65,8 @@ namespace Sonar
 
 	void Bird::Animate(float dt)
 	{
-		if (_clock.getElapsedTime().asSeconds() > BIRD_ANIMATION_DURATION / _animationFrames.size())
+		_animationTicks++;
+		if (_animationTicks > SECONDS_TO_TICKS(BIRD_ANIMATION_DURATION / _animationFrames.size()))
 		{
 			if (_animationIterator < _animationFrames.size() - 1)
 			{
@@ -57,9 +77,9 @@ namespace Sonar
 				_animationIterator = 0;
 			}
 
-			_birdSprite.setTexture(_animationFrames.at(_animationIterator));
+			_birdSprite.setTexture(*_animationFrames.at(_animationIterator));
 
-			_clock.restart();
+			_animationTicks = 0;
 		}
 	}
 
@@ -97,19 +117,39 @@ namespace Sonar
 			_birdSprite.setRotation(_rotation);
 		}
 
-		if (_movementClock.getElapsedTime().asSeconds() > (FLYING_DURATION/GAME_SPEED))
+		_movementTicks++;
+		if (_movementTicks > SECONDS_TO_TICKS(FLYING_DURATION/GAME_SPEED))
 		{
-			_movementClock.restart();
+			_movementTicks = 0;
 			_birdState = BIRD_STATE_FALLING;
 		}
 	}
 
 	void Bird::Tap()
 	{
-		_movementClock.restart();
+		_movementTicks = 0;
 		_birdState = BIRD_STATE_FLYING;
 	}
 
+	Bird::Motion Bird::GetMotion() const
+	{
+		Motion motion;
+		motion.position = _birdSprite.getPosition();
+		motion.rotation = _rotation;
+		motion.birdState = _birdState;
+		motion.movementTicks = _movementTicks;
+		return motion;
+	}
+
+	void Bird::SetMotion(const Motion& motion)
+	{
+		_birdSprite.setPosition(motion.position);
+		_rotation = motion.rotation;
+		_birdSprite.setRotation(_rotation);
+		_birdState = motion.birdState;
+		_movementTicks = motion.movementTicks;
+	}
+
 	const sf::Sprite &Bird::GetSprite() const
 	{
 		return _birdSprite;
@@ -169,24 +209,63 @@ namespace Sonar
 	}
 
 	bool Bird::FindShouldFlap(float fdistanceToPipe, float fdistanceToCentreOfPipe, float fdistanceToGround, float fdistanceToTop)
+	{
+		float inputs[NETWORK_INPUTS];
+		GetNetworkInputs(fdistanceToPipe, fdistanceToCentreOfPipe, fdistanceToGround, fdistanceToTop, inputs);
+		return FindShouldFlap(inputs);
+	}
+
+	void Bird::GetNetworkInputs(float fdistanceToPipe, float fdistanceToCentreOfPipe, float fdistanceToGround, float fdistanceToTop, float* inputs) const
 	{
 		//Normalize the values
-		float distanceToPipe = fdistanceToPipe / (SCREEN_WIDTH - 69);
-		float distanceToGround = fdistanceToGround / 763;
-		float distanceToCentreOfPipe = fdistanceToCentreOfPipe / 763;
-		float state = 0.0f;
+		inputs[0] = fdistanceToPipe / (SCREEN_WIDTH - 69);
+		inputs[1] = fdistanceToCentreOfPipe / 763;
+		inputs[2] = fdistanceToGround / 763;
+		inputs[3] = 0.0f;
 		if (_birdState == BIRD_STATE_FALLING)
-			state = 1.0f;
+			inputs[3] = 1.0f;
+	}
+
+	void Bird::CompileNetwork()
+	{
+		if (compiledNetwork != nullptr)
+			delete compiledNetwork;
+		if (genome != nullptr)
+			compiledNetwork = new NeatNetwork(*genome);
+		else
+			compiledNetwork = CompiledNetwork::Compile(nodeNetwork);
+	}
+
+	bool Bird::FindShouldFlap(const float* inputs)
+	{
+		if (compiledNetwork != nullptr)
+			return compiledNetwork->ShouldFlap(inputs);
+
+		float val = EvaluateNetwork(inputs);
+		if (val < 0)
+		{
+			return false;
+		}
+		else {
+			return true;
+		}
+	}
+
+	float Bird::EvaluateNetwork(const float* inputs)
+	{
+		if (compiledNetwork != nullptr)
+			return compiledNetwork->Evaluate(inputs);
+
 		OutputNode output = OutputNode();
 		for (int i = 0; i < nodeNetwork.size(); i++)
 		{
 			//Input layer receives inputs from the game
 			if (i == 0)
 			{
-				nodeNetwork.at(i).at(0)->AddInput(distanceToPipe);
-				nodeNetwork.at(i).at(1)->AddInput(distanceToCentreOfPipe);
-				nodeNetwork.at(i).at(2)->AddInput(distanceToGround);
-				nodeNetwork.at(i).at(3)->AddInput(state);
+				for (int j = 0; j < NETWORK_INPUTS; j++)
+				{
+					nodeNetwork.at(i).at(j)->AddInput(inputs[j]);
+				}
 			}
 
 			//iterate nodes on current layer
@@ -213,13 +292,76 @@ namespace Sonar
 				nodeNetwork.at(i).at(j)->ClearValue();
 			}
 		}
-		float val = output.GenerateOutput();
-		if (val < 0)
+		return output.GenerateOutput();
+	}
+
+	void Bird::GetInputRates(float* rates)
+	{
+		//Same normalization as GetNetworkInputs
+		float birdStep = std::max(GRAVITY, FLYING_SPEED) * GAME_SPEED * TICK_DURATION;
+		rates[0] = PIPE_MOVEMENT_SPEED * GAME_SPEED * TICK_DURATION / (SCREEN_WIDTH - 69);
+		rates[1] = birdStep / 763;
+		rates[2] = birdStep / 763;
+		//A state change is a jump, not a rate
+		rates[3] = 0.0f;
+	}
+
+	void Bird::GetInputSensitivity(float* sensitivity) const
+	{
+		if (genome != nullptr)
 		{
-			return false;
+			genome->GetInputSensitivity(sensitivity);
+			return;
 		}
-		else {
-			return true;
+		for (int input = 0; input < NETWORK_INPUTS; input++)
+		{
+			//Sensitivity of each node in the current layer to this input
+			std::vector<float> current(nodeNetwork.at(0).size(), 0.0f);
+			current.at(input) = 1.0f;
+			float output = 0.0f;
+			for (int i = 0; i < nodeNetwork.size(); i++)
+			{
+				std::vector<float> next(i + 1 < nodeNetwork.size() ? nodeNetwork.at(i + 1).size() : 0, 0.0f);
+				for (int j = 0; j < nodeNetwork.at(i).size(); j++)
+				{
+					const std::vector<float>& weights = i == 0 ? static_cast<InputNode*>(nodeNetwork.at(i).at(j))->weights : static_cast<ActivationNode*>(nodeNetwork.at(i).at(j))->weights;
+					if (nodeNetwork.at(i).at(j)->lastLayer)
+						output += current.at(j) * std::abs(weights.at(0));
+					else
+					{
+						for (int k = 0; k < next.size(); k++)
+						{
+							next.at(k) += current.at(j) * std::abs(weights.at(k));
+						}
+					}
+				}
+				current = next;
+			}
+			sensitivity[input] = output;
+		}
+	}
+
+	uint64_t Bird::GetGenomeHash() const
+	{
+		if (genome != nullptr)
+			return genome->GetHash();
+
+		//The layer sizes and the rounded parameters
+		GenomeHash hash;
+		for (int i = 0; i < nodeNetwork.size(); i++)
+		{
+			hash.Mix(nodeNetwork.at(i).size());
+			for (int j = 0; j < nodeNetwork.at(i).size(); j++)
+			{
+				const std::vector<float>& weights = i == 0 ? static_cast<InputNode*>(nodeNetwork.at(i).at(j))->weights : static_cast<ActivationNode*>(nodeNetwork.at(i).at(j))->weights;
+				for (float weight : weights)
+				{
+					hash.MixParameter(weight);
+				}
+				if (i > 0)
+					hash.MixParameter(static_cast<ActivationNode*>(nodeNetwork.at(i).at(j))->bias);
+			}
 		}
+		return hash.Get();
 	}
-}
\ No newline at end of file
+}
@@ -5,7 +5,11 @@
 #include "DEFINITIONS.hpp"
 #include "Game.hpp"
 #include "Node.h"
+#include "QuantizedNetwork.h"
+#include "CompiledNetwork.h"
+#include "NeatGenome.h"
 
+#include <cstdint>
 #include <vector>
 
 namespace Sonar
@@ -14,6 +18,8 @@ namespace Sonar
 	{
 	public:
 		Bird(GameDataRef data, std::vector<std::vector<Node*>> p_nodeNetwork);
+		//NEAT bird. nodeNetwork stays empty, the genome is always run through its compiled NeatNetwork
+		Bird(GameDataRef data, const NeatGenome& p_genome);
 		~Bird();
 
 		void Draw();
@@ -24,12 +30,36 @@ namespace Sonar
 
 		void Tap();
 
+		//Everything Update and Tap change. A replay restores it to jump back to an earlier tick
+		struct Motion
+		{
+			sf::Vector2f position;
+			float rotation;
+			int birdState;
+			int movementTicks;
+		};
+		Motion GetMotion() const;
+		void SetMotion(const Motion& motion);
+
 		const sf::Sprite &GetSprite() const;
 
 		void getHeight(int& x, int& y);
 
 		bool FindShouldFlap(float distanceToGround, float distanceToTop);
 		bool FindShouldFlap(float distanceToPipe, float distanceToCentreOfPipe, float distanceToGround, float distanceToTop);
+		//Runs the network on already normalized inputs
+		bool FindShouldFlap(const float* inputs);
+		//Raw network output, the bird flaps when it isn't negative
+		float EvaluateNetwork(const float* inputs);
+		//Normalizes the sensor distances into the NETWORK_INPUTS values the network is fed
+		void GetNetworkInputs(float distanceToPipe, float distanceToCentreOfPipe, float distanceToGround, float distanceToTop, float* inputs) const;
+		//Largest change of each network input over one tick, while the nearest pipes stay the same and the state doesn't change
+		static void GetInputRates(float* rates);
+		//Upper bound of how much the network output moves per unit change of each input. Every activation's slope is at most 1,
+		//so it's the sum over every path of the absolute weights along it
+		void GetInputSensitivity(float* sensitivity) const;
+		//Hash of the topology and of the weights and biases rounded to FITNESS_CACHE_QUANTUM
+		uint64_t GetGenomeHash() const;
 
 		int score = 0;
 		int bestScoreSoFar = 0;
@@ -44,17 +74,30 @@ namespace Sonar
 
 		std::vector<std::vector<Node*>> nodeNetwork;
 
+		//Builds the specialised copy of nodeNetwork. Call again whenever the weights change
+		void CompileNetwork();
+
+		CompiledNetwork* compiledNetwork = nullptr;
+
+		//Only set in NEAT mode
+		NeatGenome* genome = nullptr;
+
 	private:
+		//Sprite and animation setup shared by both constructors
+		void InitSprite();
+
 		GameDataRef _data;
 
 		sf::Sprite _birdSprite;
-		std::vector<sf::Texture> _animationFrames;
+		//Shared with every other bird, the AssetManager owns them
+		std::vector<const sf::Texture*> _animationFrames;
 
 		unsigned int _animationIterator;
 
-		sf::Clock _clock;
+		//Ticks since the animation frame changed, and since the last flap
+		int _animationTicks = 0;
 
-		sf::Clock _movementClock;
+		int _movementTicks = 0;
 
 		int _birdState;
 
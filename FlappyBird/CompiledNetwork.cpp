@@ -0,0 +1,44 @@
+#include "CompiledNetwork.h"
+
+namespace
+{
+	template<int... Shape>
+	bool MatchesShape(const std::vector<std::vector<Node*>>& nodeNetwork)
+	{
+		const int shape[] = { Shape... };
+		if (nodeNetwork.size() != sizeof...(Shape))
+			return false;
+		for (unsigned int i = 0; i < nodeNetwork.size(); i++)
+		{
+			if ((int)nodeNetwork.at(i).size() != shape[i])
+				return false;
+		}
+		return true;
+	}
+
+	template<int... Shape>
+	CompiledNetwork* TryCompile(const std::vector<std::vector<Node*>>& nodeNetwork)
+	{
+		if (!MatchesShape<Shape...>(nodeNetwork))
+			return nullptr;
+		return new CompiledNetworkImpl<Shape...>(nodeNetwork);
+	}
+}
+
+CompiledNetwork* CompiledNetwork::Compile(const std::vector<std::vector<Node*>>& nodeNetwork)
+{
+	//Menu of common shapes. Anything else keeps using the node network
+	CompiledNetwork* network = nullptr;
+	if (network == nullptr) network = TryCompile<4>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 3>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 4>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 5>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 6>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 8>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 12>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 16>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 4, 4>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 5, 5>(nodeNetwork);
+	if (network == nullptr) network = TryCompile<4, 8, 8>(nodeNetwork);
+	return network;
+}
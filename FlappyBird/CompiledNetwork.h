@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "Node.h"
+#include "Activation.h"
+
+//Dot product with the loop expanded at compile time
+template<int Count, int... Index>
+inline float UnrolledDot(const float* weights, const float* inputs, std::integer_sequence<int, Index...>)
+{
+	float sum = 0;
+	int expand[] = { 0, ((sum += weights[Index] * inputs[Index]), 0)... };
+	(void)expand;
+	return sum;
+}
+
+template<int Count>
+inline float UnrolledDot(const float* weights, const float* inputs)
+{
+	return UnrolledDot<Count>(weights, inputs, std::make_integer_sequence<int, Count>());
+}
+
+//Weights sent by a node to the next layer. The input layer is made of InputNodes, every other layer of ActivationNodes
+inline const std::vector<float>& GetSentWeights(const std::vector<std::vector<Node*>>& nodeNetwork, int layer, int node)
+{
+	if (layer == 0)
+		return static_cast<InputNode*>(nodeNetwork.at(layer).at(node))->weights;
+	return static_cast<ActivationNode*>(nodeNetwork.at(layer).at(node))->weights;
+}
+
+//Dense network with every size known at compile time. Network<4, 5> is 4 inputs, one hidden layer of 5 activation nodes and the output node.
+//The output node only sums, the caller applies the step function
+template<int Inputs, int... Hidden>
+class Network;
+
+//Last layer, feeding the output node
+template<int Inputs>
+class Network<Inputs>
+{
+public:
+	float Forward(const float* inputs) const
+	{
+		return UnrolledDot<Inputs>(weights.data(), inputs);
+	}
+
+	//Reads the node network starting at the given layer
+	void Load(const std::vector<std::vector<Node*>>& nodeNetwork, int layer)
+	{
+		for (int j = 0; j < Inputs; j++)
+			weights[j] = GetSentWeights(nodeNetwork, layer, j).at(0);
+	}
+
+	//weights[j] is sent by node j of this layer
+	std::array<float, Inputs> weights;
+};
+
+template<int Inputs, int Nodes, int... Rest>
+class Network<Inputs, Nodes, Rest...>
+{
+public:
+	float Forward(const float* inputs) const
+	{
+		std::array<float, Nodes> hidden;
+		ForwardLayer(inputs, hidden.data(), std::make_integer_sequence<int, Nodes>());
+		return next.Forward(hidden.data());
+	}
+
+	void Load(const std::vector<std::vector<Node*>>& nodeNetwork, int layer)
+	{
+		for (int k = 0; k < Nodes; k++)
+		{
+			for (int j = 0; j < Inputs; j++)
+				weights[k * Inputs + j] = GetSentWeights(nodeNetwork, layer, j).at(k);
+			biases[k] = static_cast<ActivationNode*>(nodeNetwork.at(layer + 1).at(k))->bias;
+		}
+		next.Load(nodeNetwork, layer + 1);
+	}
+
+	//Row k holds the weights received by node k of the next layer
+	std::array<float, Inputs * Nodes> weights;
+	std::array<float, Nodes> biases;
+	Network<Nodes, Rest...> next;
+
+private:
+	template<int... Index>
+	void ForwardLayer(const float* inputs, float* hidden, std::integer_sequence<int, Index...>) const
+	{
+		int expand[] = { 0, ((hidden[Index] = Activation::Apply(UnrolledDot<Inputs>(&weights[Index * Inputs], inputs) + biases[Index])), 0)... };
+		(void)expand;
+	}
+};
+
+//Runtime handle to one of the compiled topologies
+class CompiledNetwork
+{
+public:
+	virtual ~CompiledNetwork() { }
+
+	virtual bool ShouldFlap(const float* inputs) const = 0;
+	//Raw output, flapping when it isn't negative
+	virtual float Evaluate(const float* inputs) const = 0;
+
+	//Picks the specialisation matching the node network's shape. Returns nullptr if the shape isn't on the menu
+	static CompiledNetwork* Compile(const std::vector<std::vector<Node*>>& nodeNetwork);
+};
+
+template<int... Shape>
+class CompiledNetworkImpl : public CompiledNetwork
+{
+public:
+	CompiledNetworkImpl(const std::vector<std::vector<Node*>>& nodeNetwork)
+	{
+		network.Load(nodeNetwork, 0);
+	}
+
+	bool ShouldFlap(const float* inputs) const override
+	{
+		//Same step function as the OutputNode
+		return !(network.Forward(inputs) < 0);
+	}
+
+	float Evaluate(const float* inputs) const override
+	{
+		return network.Forward(inputs);
+	}
+
+	Network<Shape...> network;
+};
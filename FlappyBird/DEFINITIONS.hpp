@@ -39,17 +39,83 @@
 #define POINT_SOUND_FILEPATH "Resources/audio/Point.wav"
 #define WING_SOUND_FILEPATH "Resources/audio/Wing.wav"
 
+#define HIGHSCORE_FILEPATH "Resources/Highscore.txt"
+
+//Defaults for the RunConfig, override them in config.json or on the command line
 #define POPULATION_SIZE 200
 #define ELITE_SIZE 4
 #define MATING_POOL_SIZE 10
 #define CROSSOVER_RATE 1.0f
 #define MUTATION_RATE 15
-#define MUTATION_ADJUSTMENT 0.35f;
+#define MUTATION_ADJUSTMENT 0.35f
 
 #define HIDDEN_LAYERS 1
 #define NODES_PER_LAYER 5
 #define WEIGHT_MAX 1.2f
 
+//NEAT mode. Percent chances of each structural mutation per child, and the compatibility distance that splits species
+#define NEAT_ADD_NODE_RATE 3
+#define NEAT_ADD_CONNECTION_RATE 5
+#define NEAT_REMOVE_CONNECTION_RATE 2
+#define NEAT_COMPATIBILITY_THRESHOLD 3.0f
+//Weight of the unshared genes and of the mean weight difference of the shared ones in that distance
+#define NEAT_DISJOINT_COEFFICIENT 1.0f
+#define NEAT_WEIGHT_COEFFICIENT 0.4f
+
+//ES and CMA-ES. Starting spread of the samples around the mean, and the ES step along its gradient estimate
+#define OPTIMIZER_SIGMA 0.1f
+#define ES_LEARNING_RATE 0.05f
+
+//Values fed to the input layer (pipe distance, gap centre, ground distance, state)
+#define NETWORK_INPUTS 4
+
+//Hidden node activation, override it with the Activation key: Tanh, TanhTable, TanhRational, HardTanh or ReLU
+#define ACTIVATION "Tanh"
+//The tanh table covers [-range, range] in this many linear segments, beyond it tanh is within 3e-7 of +-1
+#define ACTIVATION_TABLE_RANGE 8.0f
+#define ACTIVATION_TABLE_SEGMENTS 1024
+
+//Evaluate networks through the compile time specialised topologies when the shape is on the menu
+#define COMPILED_NETWORKS true
+
+#define INFERENCE_FLOAT 0
+#define INFERENCE_INT8 1
+#define INFERENCE_FLOAT16 2
+
+//Precision of the per tick network evaluation. Quantized weights are rebuilt once per generation
+#define INFERENCE_MODE INFERENCE_FLOAT
+//Also runs the float path in quantized mode and reports how often the decisions agree. That flies every bird
+//through both networks every tick, so it is only for checking a quantization mode
+#define VALIDATE_QUANTIZED_INFERENCE false
+
+//Compiles the PROFILE_SCOPE timers in. They still only record when the Profile config key is set
+#define PROFILING_ENABLED true
+
+//Generation stop conditions, in 60Hz ticks. 0 disables a condition
+#define MAX_GENERATION_TICKS 18000
+#define TARGET_SCORE 0
+#define STAGNATION_TICKS 1800
+
+//Reuses each bird's last decision for as many ticks as its inputs provably can't flip it, and skips
+//collision checks when nothing is in reach. Decisions stay identical to evaluating every tick
+#define ANALYTIC_ADVANCE false
+//Output distance from the decision boundary kept in reserve for float rounding
+#define ANALYTIC_ADVANCE_MARGIN 0.001f
+
+//Pipe course every generation flies, 0 draws a new one each generation. The fitness cache only runs with a fixed course,
+//so it's idle with this default
+#define COURSE_SEED 0
+//Weights closer together than this hash the same in the fitness cache
+#define FITNESS_CACHE_QUANTUM 1e-6f
+
+//Genome pairs the diversity metrics measure the distance of, larger populations are sampled
+#define DIVERSITY_SAMPLED_PAIRS 2048
+#define DIVERSITY_HISTOGRAM_BUCKETS 10
+
+//Length of one fixed update. Gameplay timers count updates, not wall clock time
+#define TICK_DURATION (1.0f / 60.0f)
+#define SECONDS_TO_TICKS(seconds) ((int)((seconds) / TICK_DURATION + 0.5f))
+
 #define GAME_SPEED 1
 
 #define PIPE_MOVEMENT_SPEED 200.0f
@@ -76,10 +142,32 @@ enum GameStates
 	eGameOver
 };
 
+enum GenerationEndReasons
+{
+	eGenerationRunning,
+	eEndAllDead,
+	eEndMaxTicks,
+	eEndTargetScore,
+	eEndStagnation,
+	//Worker processes flew every bird, the generation never ticked here
+	eEndWorkers
+};
+
+//Replay viewer. Ticks between the snapshots seeking restarts from, and how far the arrow keys seek
+#define REPLAY_SNAPSHOT_INTERVAL 300
+#define REPLAY_SEEK_SECONDS 5.0f
+
+//How often the training overlay's text is refreshed, and how many generations its curve shows
+#define HUD_STATS_INTERVAL 0.5f
+#define HUD_CURVE_POINTS 100
+
 #define FLASH_SPEED 1500.0f
 
 #define TIME_BEFORE_GAME_OVER_APPEARS 1.5f
 
+//Generations the highscore is kept in memory between writes to the highscore file
+#define HIGHSCORE_FLUSH_INTERVAL 50
+
 #define BRONZE_MEDAL_SCORE 0
 #define SILVER_MEDAL_SCORE 5
 #define GOLD_MEDAL_SCORE 25
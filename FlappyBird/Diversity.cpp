@@ -0,0 +1,157 @@
+#include "Diversity.h"
+#include "GenomeHash.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+
+//Fixed so the sampled distance of a population is the same every time it's measured
+#define DIVERSITY_SAMPLE_SEED 12345
+
+namespace
+{
+	float Distance(const float* first, const float* second, int length)
+	{
+		float sum = 0.0f;
+		for (int i = 0; i < length; i++)
+		{
+			float difference = first[i] - second[i];
+			sum += difference * difference;
+		}
+		return std::sqrt(sum);
+	}
+
+	uint64_t HashGenome(const float* genome, int length)
+	{
+		//The rounded parameters
+		GenomeHash hash;
+		for (int i = 0; i < length; i++)
+		{
+			hash.MixParameter(genome[i]);
+		}
+		return hash.Get();
+	}
+}
+
+bool GenomeBuffer::AddGenome(const std::vector<std::vector<Node*>>& nodeNetwork)
+{
+	size_t start = parameters.size();
+	for (int i = 0; i < (int)nodeNetwork.size(); i++)
+	{
+		for (int j = 0; j < (int)nodeNetwork.at(i).size(); j++)
+		{
+			if (i == 0)
+			{
+				const std::vector<float>& weights = static_cast<InputNode*>(nodeNetwork.at(i).at(j))->weights;
+				parameters.insert(parameters.end(), weights.begin(), weights.end());
+			}
+			else
+			{
+				ActivationNode* node = static_cast<ActivationNode*>(nodeNetwork.at(i).at(j));
+				parameters.insert(parameters.end(), node->weights.begin(), node->weights.end());
+				parameters.push_back(node->bias);
+			}
+		}
+	}
+
+	int added = (int)(parameters.size() - start);
+	if (genomeCount == 0)
+		parameterCount = added;
+	else if (added != parameterCount)
+	{
+		parameters.resize(start);
+		return false;
+	}
+	genomeCount++;
+	return true;
+}
+
+void GenomeBuffer::Clear()
+{
+	parameters.clear();
+	genomeCount = 0;
+	parameterCount = 0;
+}
+
+DiversityMetrics MeasureDiversity(const GenomeBuffer& genomes, const std::vector<int>& scores)
+{
+	DiversityMetrics metrics;
+	int count = genomes.GetGenomeCount();
+	int length = genomes.GetParameterCount();
+	if (count == 0)
+		return metrics;
+
+	//Per parameter variance in one pass down the rows, the inner loop is contiguous
+	std::vector<double> sum(length, 0.0);
+	std::vector<double> sumOfSquares(length, 0.0);
+	for (int i = 0; i < count; i++)
+	{
+		const float* genome = genomes.GetGenome(i);
+		for (int j = 0; j < length; j++)
+		{
+			sum[j] += genome[j];
+			sumOfSquares[j] += (double)genome[j] * genome[j];
+		}
+	}
+	metrics.parameterVariance.resize(length);
+	for (int j = 0; j < length; j++)
+	{
+		double mean = sum[j] / count;
+		float variance = (float)std::max(0.0, sumOfSquares[j] / count - mean * mean);
+		metrics.parameterVariance[j] = variance;
+		metrics.meanVariance += variance / length;
+		metrics.maxVariance = std::max(metrics.maxVariance, variance);
+	}
+
+	//Every pair when there are few enough, otherwise a fixed random sample of them
+	double totalDistance = 0.0;
+	long long allPairs = (long long)count * (count - 1) / 2;
+	if (allPairs <= DIVERSITY_SAMPLED_PAIRS)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			for (int j = i + 1; j < count; j++)
+			{
+				totalDistance += Distance(genomes.GetGenome(i), genomes.GetGenome(j), length);
+			}
+		}
+		metrics.pairsMeasured = (int)allPairs;
+	}
+	else
+	{
+		std::mt19937 random(DIVERSITY_SAMPLE_SEED);
+		for (int pair = 0; pair < DIVERSITY_SAMPLED_PAIRS; pair++)
+		{
+			int first = random() % count;
+			int second = random() % (count - 1);
+			if (second >= first)
+				second++;
+			totalDistance += Distance(genomes.GetGenome(first), genomes.GetGenome(second), length);
+		}
+		metrics.pairsMeasured = DIVERSITY_SAMPLED_PAIRS;
+	}
+	if (metrics.pairsMeasured > 0)
+		metrics.meanPairwiseDistance = (float)(totalDistance / metrics.pairsMeasured);
+
+	std::unordered_set<uint64_t> hashes;
+	for (int i = 0; i < count; i++)
+	{
+		hashes.insert(HashGenome(genomes.GetGenome(i), length));
+	}
+	metrics.uniqueGenomes = (int)hashes.size();
+
+	//Buckets wide enough for the best score to land in the last one
+	int bestScore = 0;
+	for (int score : scores)
+	{
+		bestScore = std::max(bestScore, score);
+	}
+	metrics.histogramBucketWidth = std::max(1, (bestScore + DIVERSITY_HISTOGRAM_BUCKETS) / DIVERSITY_HISTOGRAM_BUCKETS);
+	metrics.fitnessHistogram.assign(DIVERSITY_HISTOGRAM_BUCKETS, 0);
+	for (int score : scores)
+	{
+		int bucket = std::min(std::max(score, 0) / metrics.histogramBucketWidth, DIVERSITY_HISTOGRAM_BUCKETS - 1);
+		metrics.fitnessHistogram[bucket]++;
+	}
+	return metrics;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Node.h"
+#include "DEFINITIONS.hpp"
+
+//Every genome's weights and biases flattened into one row per bird, in the order the network stores them.
+//Metrics run straight down the rows instead of chasing node pointers
+class GenomeBuffer
+{
+public:
+	//Appends a bird's network. Returns false if its parameter count doesn't match the first genome
+	bool AddGenome(const std::vector<std::vector<Node*>>& nodeNetwork);
+	void Clear();
+
+	int GetGenomeCount() const { return genomeCount; }
+	int GetParameterCount() const { return parameterCount; }
+	const float* GetGenome(int index) const { return &parameters[index * parameterCount]; }
+
+private:
+	std::vector<float> parameters;
+	int genomeCount = 0;
+	int parameterCount = 0;
+};
+
+//How spread out a population is, and how its scores are distributed
+struct DiversityMetrics
+{
+	//Mean euclidean distance between genomes, over every pair or DIVERSITY_SAMPLED_PAIRS random ones
+	float meanPairwiseDistance = 0.0f;
+	int pairsMeasured = 0;
+	//Variance of each parameter across the population
+	std::vector<float> parameterVariance;
+	float meanVariance = 0.0f;
+	float maxVariance = 0.0f;
+	//Genomes that differ after rounding to FITNESS_CACHE_QUANTUM
+	int uniqueGenomes = 0;
+	//DIVERSITY_HISTOGRAM_BUCKETS counts, bucket i holds scores [i * width, (i + 1) * width)
+	std::vector<int> fitnessHistogram;
+	int histogramBucketWidth = 1;
+};
+
+//scores holds one score per genome. The pair sampling uses its own generator, so it doesn't disturb rand()
+DiversityMetrics MeasureDiversity(const GenomeBuffer& genomes, const std::vector<int>& scores);
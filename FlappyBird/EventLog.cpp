@@ -0,0 +1,208 @@
+#include "EventLog.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+//Must be a power of two
+#define EVENT_LOG_CAPACITY 16384
+#define EVENT_LOG_DRAIN_INTERVAL_MS 50
+
+namespace Sonar
+{
+	namespace
+	{
+		const char* levelNames[] = { "Debug", "Info", "Warning", "Error", "Off" };
+		const char* eventNames[] = { "Tap", "Death", "Generation" };
+
+		struct LogEntry
+		{
+			LogLevel level;
+			LogEvent event;
+			int subject;
+			int value;
+		};
+
+		//Bounded multi producer queue, each slot's sequence tells producers and the consumer whose turn it is
+		struct LogSlot
+		{
+			std::atomic<unsigned int> sequence;
+			LogEntry entry;
+		};
+
+		struct LogState
+		{
+			LogSlot slots[EVENT_LOG_CAPACITY];
+			std::atomic<unsigned int> head{ 0 };
+			unsigned int tail = 0;
+
+			std::atomic<int> level{ eLogInfo };
+			std::atomic<bool> countersOnly{ false };
+			std::atomic<long long> counts[eEventCount];
+			std::atomic<long long> dropped{ 0 };
+
+			std::thread writer;
+			std::mutex writerMutex;
+			std::condition_variable wake;
+			bool running = false;
+
+			LogState()
+			{
+				for (unsigned int i = 0; i < EVENT_LOG_CAPACITY; i++)
+				{
+					slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+				for (int i = 0; i < eEventCount; i++)
+				{
+					counts[i].store(0, std::memory_order_relaxed);
+				}
+			}
+
+			~LogState()
+			{
+				EventLog::Stop();
+			}
+		};
+
+		LogState& GetState()
+		{
+			static LogState state;
+			return state;
+		}
+
+		bool Push(LogState& state, const LogEntry& entry)
+		{
+			unsigned int position = state.head.load(std::memory_order_relaxed);
+			LogSlot* slot;
+			while (true)
+			{
+				slot = &state.slots[position & (EVENT_LOG_CAPACITY - 1)];
+				int difference = (int)(slot->sequence.load(std::memory_order_acquire) - position);
+				if (difference == 0)
+				{
+					if (state.head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+					return false; //Full
+				else
+					position = state.head.load(std::memory_order_relaxed);
+			}
+			slot->entry = entry;
+			slot->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		//Only called from the writer thread, or after it has been joined
+		void Drain(LogState& state)
+		{
+			bool wrote = false;
+			while (true)
+			{
+				LogSlot& slot = state.slots[state.tail & (EVENT_LOG_CAPACITY - 1)];
+				if (slot.sequence.load(std::memory_order_acquire) != state.tail + 1)
+					break;
+				LogEntry entry = slot.entry;
+				slot.sequence.store(state.tail + EVENT_LOG_CAPACITY, std::memory_order_release);
+				state.tail++;
+
+				std::cout << "[" << levelNames[entry.level] << "] " << eventNames[entry.event] << " " << entry.subject << " " << entry.value << "\n";
+				wrote = true;
+			}
+
+			long long dropped = state.dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0)
+			{
+				std::cout << "[Warning] Event log full, dropped " << dropped << " events\n";
+				wrote = true;
+			}
+			//One flush per drain instead of one per event
+			if (wrote)
+				std::cout.flush();
+		}
+
+		void WriterLoop()
+		{
+			LogState& state = GetState();
+			std::unique_lock<std::mutex> lock(state.writerMutex);
+			while (state.running)
+			{
+				state.wake.wait_for(lock, std::chrono::milliseconds(EVENT_LOG_DRAIN_INTERVAL_MS));
+				lock.unlock();
+				Drain(state);
+				lock.lock();
+			}
+		}
+	}
+
+	void EventLog::Start(LogLevel level, bool countersOnly)
+	{
+		LogState& state = GetState();
+		state.level = level;
+		state.countersOnly = countersOnly;
+
+		std::lock_guard<std::mutex> lock(state.writerMutex);
+		if (state.running || countersOnly || level == eLogOff)
+			return;
+		state.running = true;
+		state.writer = std::thread(WriterLoop);
+	}
+
+	void EventLog::Stop()
+	{
+		LogState& state = GetState();
+		{
+			std::lock_guard<std::mutex> lock(state.writerMutex);
+			if (!state.running)
+				return;
+			state.running = false;
+		}
+		state.wake.notify_one();
+		state.writer.join();
+		Drain(state);
+	}
+
+	void EventLog::Write(LogLevel level, LogEvent event, int subject, int value)
+	{
+		LogState& state = GetState();
+		state.counts[event].fetch_add(1, std::memory_order_relaxed);
+
+		if (state.countersOnly.load(std::memory_order_relaxed) || level < state.level.load(std::memory_order_relaxed))
+			return;
+
+		LogEntry entry;
+		entry.level = level;
+		entry.event = event;
+		entry.subject = subject;
+		entry.value = value;
+		if (!Push(state, entry))
+			state.dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	long long EventLog::GetCount(LogEvent event)
+	{
+		return GetState().counts[event].load(std::memory_order_relaxed);
+	}
+
+	void EventLog::ResetCounts()
+	{
+		LogState& state = GetState();
+		for (int i = 0; i < eEventCount; i++)
+		{
+			state.counts[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	LogLevel EventLog::ParseLevel(const std::string& name)
+	{
+		for (int i = eLogDebug; i <= eLogOff; i++)
+		{
+			if (name == levelNames[i])
+				return (LogLevel)i;
+		}
+		return eLogInfo;
+	}
+}
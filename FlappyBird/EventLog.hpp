@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+
+namespace Sonar
+{
+	enum LogLevel
+	{
+		eLogDebug,
+		eLogInfo,
+		eLogWarning,
+		eLogError,
+		eLogOff
+	};
+
+	enum LogEvent
+	{
+		eEventTap,
+		eEventDeath,
+		eEventGeneration,
+		eEventCount
+	};
+
+	//Simulation events, counted on the calling thread and queued into a ring buffer that a background thread
+	//drains to the console, so the tick never waits on stdout. Full buffers drop events rather than block
+	class EventLog
+	{
+	public:
+		//Events below level are only counted. countersOnly skips the queue altogether
+		static void Start(LogLevel level, bool countersOnly);
+		//Drains what's left and joins the writer thread
+		static void Stop();
+
+		//subject is the bird index for bird events, value is event specific (score, generation...)
+		static void Write(LogLevel level, LogEvent event, int subject, int value);
+
+		//Number of events written since the last ResetCounts, whether or not they were queued
+		static long long GetCount(LogEvent event);
+		static void ResetCounts();
+
+		//"Debug", "Info", "Warning", "Error" or "Off". Unknown names fall back to Info
+		static LogLevel ParseLevel(const std::string& name);
+	};
+}
@@ -0,0 +1,28 @@
+#include "FitnessCache.hpp"
+
+namespace Sonar
+{
+	bool FitnessCache::Find(uint64_t genomeHash, unsigned int courseSeed, int& score)
+	{
+		_lookups++;
+		auto found = _scores.find(MakeKey(genomeHash, courseSeed));
+		if (found == _scores.end())
+			return false;
+		_hits++;
+		score = found->second;
+		return true;
+	}
+
+	void FitnessCache::Store(uint64_t genomeHash, unsigned int courseSeed, int score)
+	{
+		_scores[MakeKey(genomeHash, courseSeed)] = score;
+	}
+
+	uint64_t FitnessCache::MakeKey(uint64_t genomeHash, unsigned int courseSeed)
+	{
+		//Spread the seed over every bit before mixing it in, nearby seeds mustn't cancel out the hash
+		uint64_t seed = (courseSeed + 1) * 0x9E3779B97F4A7C15ull;
+		seed ^= seed >> 31;
+		return genomeHash ^ seed;
+	}
+}
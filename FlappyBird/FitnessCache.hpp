@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace Sonar
+{
+	//Scores of genomes that have already flown a course. Birds don't interact and a seeded course plays out the same
+	//every time, so a genome flown again on the same course can take its old score instead of being simulated
+	class FitnessCache
+	{
+	public:
+		//False if the genome hasn't flown this course yet
+		bool Find(uint64_t genomeHash, unsigned int courseSeed, int& score);
+		void Store(uint64_t genomeHash, unsigned int courseSeed, int score);
+
+		int GetSize() const { return (int)_scores.size(); }
+		long long GetHits() const { return _hits; }
+		long long GetLookups() const { return _lookups; }
+
+	private:
+		static uint64_t MakeKey(uint64_t genomeHash, unsigned int courseSeed);
+
+		std::unordered_map<uint64_t, int> _scores;
+		long long _hits = 0;
+		long long _lookups = 0;
+	};
+}
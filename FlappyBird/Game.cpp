@@ -1,20 +1,61 @@
 #include "Game.hpp"
 #include "SplashState.hpp"
+#include "ReplayState.hpp"
+#include "RemoteWorkerState.hpp"
+#include "Profiler.hpp"
+#include "EventLog.hpp"
+#include "Process.hpp"
+#include "Activation.h"
 
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
 #include <stdlib.h>
 #include <time.h>
 
 
 namespace Sonar
 {
-	Game::Game(int width, int height, std::string title)
+	Game::Game(int width, int height, std::string title, const RunConfig& config)
 	{
-		srand((unsigned int)time(NULL));
+		_data->config = config;
+		Profiler::SetEnabled(_data->config.profile);
+		EventLog::Start(EventLog::ParseLevel(_data->config.logLevel), _data->config.logCountersOnly);
+		Activation::Select(Activation::ParseType(_data->config.activation));
+
+		//A fixed seed makes the whole run reproducible, the genetic algorithm and the course seeds both come from rand()
+		srand(_data->config.seed != 0 ? _data->config.seed : (unsigned int)time(NULL));
+		_data->workers.Start(_data->config.threads);
+		auto startTime = std::chrono::steady_clock::now();
+
+		//Workers only fly what the coordinator sends them, there's nothing to watch
+		if (!_data->config.coordinator.empty())
+			_data->config.headless = true;
 
 		_data->window.create(sf::VideoMode(width, height), title, sf::Style::Close | sf::Style::Titlebar);
-		_data->machine.AddState(new SplashState(this->_data));
+		if (_data->config.headless)
+		{
+			_data->window.setVisible(false);
+		}
+		if (_data->config.coordinatorPort > 0)
+			_data->coordinator.Listen(_data->config);
+
+		if (!_data->config.replayFile.empty())
+			_data->machine.AddState(new ReplayState(this->_data, _data->config.replayFile));
+		else if (!_data->config.coordinator.empty())
+			_data->machine.AddState(new RemoteWorkerState(this->_data));
+		else
+			_data->machine.AddState(new SplashState(this->_data));
 
 		this->Run();
+		_data->highScore.Flush();
+
+		EventLog::Stop();
+		if (!_data->config.statsFile.empty())
+		{
+			WriteStats(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+		}
 	}
 
 	void Game::Run()
@@ -28,26 +69,64 @@ namespace Sonar
 		{
 			this->_data->machine.ProcessStateChanges();
 
-			newTime = this->_clock.getElapsedTime().asSeconds();
-			frameTime = newTime - currentTime;
-
-			if (frameTime > 0.25f)
+			if (this->_data->config.headless)
 			{
-				frameTime = 0.25f;
+				//Nothing is drawn and every gameplay timer counts ticks, so there's no real time to keep up with
+				accumulator = dt;
 			}
+			else
+			{
+				newTime = this->_clock.getElapsedTime().asSeconds();
+				frameTime = newTime - currentTime;
 
-			currentTime = newTime;
-			accumulator += frameTime;
+				if (frameTime > 0.25f)
+				{
+					frameTime = 0.25f;
+				}
+
+				currentTime = newTime;
+				accumulator += frameTime;
+			}
 
 			while (accumulator >= dt)
 			{
-				this->_data->machine.GetActiveState()->HandleInput();
-				this->_data->machine.GetActiveState()->Update(dt);
+				{
+					PROFILE_SCOPE("HandleInput");
+					this->_data->machine.GetActiveState()->HandleInput();
+				}
+				{
+					PROFILE_SCOPE("Update");
+					this->_data->machine.GetActiveState()->Update(dt);
+				}
+				PROFILE_COUNT("Ticks", 1);
 				accumulator -= dt;
 			}
 
-			interpolation = accumulator / dt;
-			this->_data->machine.GetActiveState()->Draw(interpolation);
+			if (!this->_data->config.headless)
+			{
+				PROFILE_SCOPE("Draw");
+				interpolation = accumulator / dt;
+				this->_data->machine.GetActiveState()->Draw(interpolation);
+			}
+		}
+	}
+
+	void Game::WriteStats(double seconds)
+	{
+		nlohmann::json stats;
+		stats["Generations"] = _data->stats.generations;
+		stats["BirdTicks"] = _data->stats.birdTicks;
+		stats["Seconds"] = seconds;
+		stats["Threads"] = _data->workers.GetThreadCount();
+		stats["PeakMemory"] = GetPeakMemoryUsage();
+		stats["Allocations"] = GetAllocationCount();
+
+		std::ofstream statsFile(_data->config.statsFile);
+		if (!statsFile.good())
+		{
+			std::cout << "Error Writing Stats " << _data->config.statsFile << std::endl;
+			return;
 		}
+		statsFile << std::setw(4) << stats << std::endl;
 	}
 }
\ No newline at end of file
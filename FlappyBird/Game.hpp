@@ -2,19 +2,48 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include "StateMachine.hpp"
 #include "AssetManager.hpp"
 #include "InputManager.hpp"
+#include "RunConfig.hpp"
+#include "DEFINITIONS.hpp"
+#include "WorkerPool.hpp"
+#include "FitnessCache.hpp"
+#include "RemoteEvaluation.hpp"
+#include "HighScore.hpp"
+#include "Optimizer.h"
 
 namespace Sonar
 {
+	//Totals over every generation this process has trained
+	struct TrainingStats
+	{
+		int generations = 0;
+		long long birdTicks = 0;
+		//Best and mean score of each generation, in order. Drawn by the HUD
+		std::vector<int> bestScores;
+		std::vector<float> meanScores;
+	};
+
 	struct GameData
 	{
 		StateMachine machine;
 		sf::RenderWindow window;
 		AssetManager assets;
 		InputManager input;
+		RunConfig config;
+		WorkerPool workers;
+		TrainingStats stats;
+		//Kept across generations, elites and repeated children are looked up here
+		FitnessCache fitnessCache;
+		//Connections to other processes, kept open across generations
+		Coordinator coordinator;
+		RemoteWorker remoteWorker;
+		HighScore highScore;
+		//Search state of the ES or CMA-ES optimizer, created by the first generation that uses one
+		std::unique_ptr<Optimizer> optimizer;
 	};
 
 	typedef std::shared_ptr<GameData> GameDataRef;
@@ -22,15 +51,17 @@ namespace Sonar
 	class Game
 	{
 	public:
-		Game(int width, int height, std::string title);
+		Game(int width, int height, std::string title, const RunConfig& config);
 
 	private:
 		// Updates run at 60 per second.
-		const float dt = 1.0f / 60.0f;
+		const float dt = TICK_DURATION;
 		sf::Clock _clock;
 
 		GameDataRef _data = std::make_shared<GameData>();
 
 		void Run();
+		//Writes the TrainingStats and process counters to the run config's stats file
+		void WriteStats(double seconds);
 	};
 }
\ No newline at end of file
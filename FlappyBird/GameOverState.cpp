@@ -4,7 +4,6 @@
 #include "GameState.hpp"
 
 #include <iostream>
-#include <fstream>
 
 namespace Sonar
 {
@@ -16,32 +15,9 @@ namespace Sonar
     void GameOverState::Init()
     {
         elapsedTime = 0;
-        std::ifstream readFile;
-        readFile.open( "Resources/Highscore.txt" );
-        
-        if ( readFile.is_open( ) )
-        {
-            while ( !readFile.eof( ) )
-            {
-                readFile >> _highScore;
-            }
-        }
-        
-        readFile.close( );
-        
-        std::ofstream writeFile( "Resources/Highscore.txt" );
-        
-        if ( writeFile.is_open( ) )
-        {
-            if ( _score > _highScore )
-            {
-                _highScore = _score;
-            }
-            
-            writeFile << _highScore;
-        }
-        
-        writeFile.close( );
+        //Kept in memory, the file is only written every few generations
+        _data->highScore.Submit(_score);
+        _highScore = _data->highScore.Get();
         
         this->_data->assets.LoadTexture("Game Over Background", GAME_OVER_BACKGROUND_FILEPATH);
         this->_data->assets.LoadTexture("Game Over Title", GAME_OVER_TITLE_FILEPATH);
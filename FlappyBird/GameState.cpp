@@ -5,13 +5,24 @@
 #include "GameState.hpp"
 #include "GameOverState.hpp"
 #include "AIController.h"
-
+#include "Process.hpp"
+#include "Profiler.hpp"
+#include "EventLog.hpp"
+#include "PopulationFile.hpp"
+#include "HeadlessEvaluator.hpp"
+#include "RemoteWorkerState.hpp"
+
+#include <algorithm>
 #include <iostream>
-
-#define REPLAY false
+#include <numeric>
 
 #define PLAY_WITH_AI 1
 
+namespace
+{
+	const char* endReasonNames[] = { "Running", "AllDead", "MaxTicks", "TargetScore", "Stagnation", "Workers" };
+}
+
 namespace Sonar
 {
 	GameState::GameState(GameDataRef data) : _data(data)
@@ -31,6 +42,8 @@ namespace Sonar
 			delete flash;
 		if (hud != nullptr)
 			delete hud;
+		if (quantizedPopulation != nullptr)
+			delete quantizedPopulation;
 		for (auto bird : birds)
 		{
 			if(bird != nullptr)
@@ -43,98 +56,219 @@ namespace Sonar
 
 	void GameState::Init()
 	{
-		if (!_hitSoundBuffer.loadFromFile(HIT_SOUND_FILEPATH))
-		{
-			std::cout << "Error Loading Hit Sound Effect" << std::endl;
-		}
-
-		if (!_wingSoundBuffer.loadFromFile(WING_SOUND_FILEPATH))
-		{
-			std::cout << "Error Loading Wing Sound Effect" << std::endl;
-		}
-
-		if (!_pointSoundBuffer.loadFromFile(POINT_SOUND_FILEPATH))
-		{
-			std::cout << "Error Loading Point Sound Effect" << std::endl;
-		}
-
-		_hitSound.setBuffer(_hitSoundBuffer);
-		_wingSound.setBuffer(_wingSoundBuffer);
-		_pointSound.setBuffer(_pointSoundBuffer);
-
-		this->_data->assets.LoadTexture("Game Background", GAME_BACKGROUND_FILEPATH);
-		this->_data->assets.LoadTexture("Pipe Up", PIPE_UP_FILEPATH);
-		this->_data->assets.LoadTexture("Pipe Down", PIPE_DOWN_FILEPATH);
-		this->_data->assets.LoadTexture("Land", LAND_FILEPATH);
-		this->_data->assets.LoadTexture("Bird Frame 1", BIRD_FRAME_1_FILEPATH);
-		this->_data->assets.LoadTexture("Bird Frame 2", BIRD_FRAME_2_FILEPATH);
-		this->_data->assets.LoadTexture("Bird Frame 3", BIRD_FRAME_3_FILEPATH);
-		this->_data->assets.LoadTexture("Bird Frame 4", BIRD_FRAME_4_FILEPATH);
-		this->_data->assets.LoadTexture("Scoring Pipe", SCORING_PIPE_FILEPATH);
-		this->_data->assets.LoadFont("Flappy Font", FLAPPY_FONT_FILEPATH);
+		LoadAssets();
 
 		pipe = new Pipe(_data);
 		land = new Land(_data);
 
-		std::string epochDirectory = "epochs/";
-		json populationData;
+		const RunConfig& config = _data->config;
+		std::string epochDirectory = config.epochDirectory;
+		replayMode = !config.replayEpoch.empty();
+		remoteBatch = _data->remoteWorker.HasBatch();
+		workerMode = !config.workerPopulation.empty() || remoteBatch;
 		generationNumber = -1;
 
-		while (true)
+		PopulationFile population;
+		if (remoteBatch)
+		{
+			//A batch the coordinator sent over the network, the whole of it is flown here
+			const EvaluationBatch& batch = _data->remoteWorker.GetBatch();
+			generationNumber = batch.generation;
+			size_t genomeParameters = batch.parameters.size() / std::max(batch.genomeCount, 1);
+			for (int i = 0; i < batch.genomeCount; i++)
+			{
+				birds.push_back(new Bird(_data, PopulationFile::BuildNetwork(batch.layerSizes.data(), (int)batch.layerSizes.size(),
+					batch.parameters.data() + i * genomeParameters)));
+			}
+		}
+		else if (workerMode)
+		{
+			//This process only flies its share of a population the coordinator evolved
+			if (population.Open(config.workerPopulation))
+			{
+				generationNumber = population.GetGeneration();
+				int genomeCount = population.GetGenomeCount();
+				workerFirstGenome = (int)((long long)genomeCount * config.workerIndex / config.workerCount);
+				int workerEndGenome = (int)((long long)genomeCount * (config.workerIndex + 1) / config.workerCount);
+				for (int i = workerFirstGenome; i < workerEndGenome; i++)
+				{
+					birds.push_back(new Bird(_data, population.CreateNetwork(i)));
+				}
+			}
+		}
+		else if (replayMode)
 		{
-			std::ifstream epochFile(epochDirectory + "epoch" + std::to_string(generationNumber + 1) + ".json");
-			if (!epochFile.good())
-				break; //File doesn't exist, end here
-			populationData = json::parse(epochFile);
-			generationNumber++;
+			std::string fileName = config.replayEpoch;
+			if (fileName.find_first_not_of("0123456789") == std::string::npos)
+			{
+				generationNumber = std::atoi(fileName.c_str());
+				fileName = epochDirectory + "epoch" + fileName + ".json";
+			}
+			ImportBirds(_data, ReadEpoch(fileName, config.top), config.top);
 		}
-		//If this is the first generation, create pop0
-		if (generationNumber == -1)
+		else
 		{
-			generationNumber++;
-			for (int i = 0; i < POPULATION_SIZE; i++)
+			//The optimizers search the fixed layout's weight vector, NEAT changes the layout itself
+			bool useOptimizer = config.optimizer != "GA" && !config.neat;
+			//Only the newest epoch is read
+			while (FileExists(epochDirectory + "epoch" + std::to_string(generationNumber + 1) + ".json"))
 			{
-				//Initialize the bird with random gene data
-				std::vector<std::vector<Node*>> _nodeNetwork = std::vector<std::vector<Node*>>();
+				generationNumber++;
+			}
 
-				std::vector<Node*> inputNodes = std::vector<Node*>();
-				for (int i = 0; i < 4; i++)
+			//If this is the first generation, create pop0
+			if (generationNumber == -1)
+			{
+				generationNumber++;
+				if (useOptimizer)
+					AskOptimizer();
+				for (int i = birds.size(); i < config.populationSize; i++)
 				{
-					if(HIDDEN_LAYERS == 0)
-						inputNodes.push_back(new InputNode(true));
-					else
-						inputNodes.push_back(new InputNode(false));
+					birds.push_back(CreateRandomBird());
 				}
-				_nodeNetwork.push_back(inputNodes);
-				for (int i = 0; i < HIDDEN_LAYERS; i++)
+			}
+			else if (useOptimizer)
+			{
+				generationNumber++;
+				AskOptimizer();
+			}
+			else
+			{
+				ImportBirds(_data, ReadEpoch(epochDirectory + "epoch" + std::to_string(generationNumber) + ".json", config.populationSize), config.populationSize);
+				if (config.neat)
+					EvolveNeat(_data);
+				else
+					Evolve(_data);
+				generationNumber++;
+			}
+		}
+		//Reset the imported score to 0
+		for (auto bird : birds)
+		{
+			bird->score = 0;
+		}
+
+
+		if (config.compiledNetworks)
+		{
+			for (auto bird : birds)
+			{
+				bird->CompileNetwork();
+			}
+		}
+
+		//NEAT genomes have no fixed layout to quantize
+		if (config.inferenceMode != INFERENCE_FLOAT && !config.neat)
+		{
+			//Convert the weights once, they don't change until the next generation
+			quantizedPopulation = new QuantizedPopulation(config.inferenceMode == INFERENCE_INT8 ? eQuantizeInt8 : eQuantizeFloat16);
+			for (auto bird : birds)
+			{
+				if (!quantizedPopulation->AddNetwork(bird->nodeNetwork))
 				{
-					std::vector<Node*> layer = std::vector<Node*>();
-					for (int j = 0; j < NODES_PER_LAYER; j++)
-					{
-						if(i == HIDDEN_LAYERS - 1)
-							layer.push_back(new ActivationNode(true));
-						else
-							layer.push_back(new ActivationNode(false));
-					}
-					_nodeNetwork.push_back(layer);
+					std::cout << "Birds have mismatched topologies, using float inference" << std::endl;
+					delete quantizedPopulation;
+					quantizedPopulation = nullptr;
+					break;
 				}
-				birds.push_back(new Bird(_data, _nodeNetwork));
 			}
 		}
+		bool training = !replayMode && !workerMode;
+		if (remoteBatch)
+			courseSeed = _data->remoteWorker.GetBatch().courseSeed;
+		else if (workerMode)
+			courseSeed = population.GetCourseSeed();
 		else
+			courseSeed = config.courseSeed != 0 ? config.courseSeed : (unsigned int)rand();
+		pipe->SetCourseSeed(courseSeed);
+		flights.assign(config.recordReplays && training ? birds.size() : 0, Replay());
+
+		//Genomes that already flew this course start the generation dead with their old score
+		liveBirds.clear();
+		lifetimes.assign(birds.size(), 0);
+		genomeHashes.assign(birds.size(), 0);
+		cachedFitness.assign(birds.size(), 0);
+		bool useFitnessCache = config.fitnessCache && config.courseSeed != 0 && training;
+		for (int i = 0; i < birds.size(); i++)
 		{
-			ImportBirds(_data, populationData);
-			#if REPLAY == false
-			Evolve(_data);
-			generationNumber++;
-			#endif
-			//Reset the imported score to 0
-			for (auto bird : birds)
+			int score = 0;
+			if (useFitnessCache)
 			{
-				bird->score = 0;
+				genomeHashes.at(i) = birds.at(i)->GetGenomeHash();
+				cachedFitness.at(i) = _data->fitnessCache.Find(genomeHashes.at(i), courseSeed, score) ? 1 : 0;
 			}
+			if (cachedFitness.at(i))
+			{
+				birds.at(i)->isAlive = false;
+				birds.at(i)->score = score;
+				birds.at(i)->bestScoreSoFar = std::max(birds.at(i)->bestScoreSoFar, score);
+			}
+			else
+				liveBirds.push_back(i);
 		}
 
+		evaluatedByWorkers = false;
+		//Workers are sent fixed layout genomes, NEAT generations are flown here
+		if ((config.workers > 0 || _data->coordinator.IsListening()) && training && !config.neat && !liveBirds.empty())
+		{
+			std::vector<Bird*> workerBirds;
+			for (int i : liveBirds)
+			{
+				workerBirds.push_back(birds.at(i));
+			}
+			std::vector<int> scores;
+			bool evaluated;
+			if (_data->coordinator.IsListening())
+				evaluated = _data->coordinator.Evaluate(workerBirds, courseSeed, generationNumber, scores);
+			else
+			{
+				HeadlessEvaluator evaluator(config);
+				evaluated = evaluator.Evaluate(workerBirds, courseSeed, generationNumber, scores);
+			}
+			if (evaluated)
+			{
+				//Every bird has flown, the generation ends on the first tick
+				for (int i = 0; i < workerBirds.size(); i++)
+				{
+					workerBirds.at(i)->isAlive = false;
+					workerBirds.at(i)->score = scores.at(i);
+					workerBirds.at(i)->bestScoreSoFar = std::max(workerBirds.at(i)->bestScoreSoFar, scores.at(i));
+				}
+				liveBirds.clear();
+				evaluatedByWorkers = true;
+			}
+			//An idle coordinator already said it's flying generations here until a worker connects
+			else if (!_data->coordinator.IsIdle())
+				std::cout << "Worker evaluation failed, flying generation " << generationNumber << " here" << std::endl;
+		}
+		networkInputs.resize(birds.size() * NETWORK_INPUTS);
+		flapDecisions.resize(birds.size());
+		if (config.analyticAdvance && !birds.empty())
+		{
+			//Weights are fixed for the generation, so is the fastest the output can move
+			float rates[NETWORK_INPUTS];
+			Bird::GetInputRates(rates);
+			decisionSlope.resize(birds.size());
+			for (int i = 0; i < birds.size(); i++)
+			{
+				float sensitivity[NETWORK_INPUTS];
+				birds.at(i)->GetInputSensitivity(sensitivity);
+				decisionSlope.at(i) = 0.0f;
+				for (int j = 0; j < NETWORK_INPUTS; j++)
+				{
+					decisionSlope.at(i) += sensitivity[j] * rates[j];
+				}
+			}
+			decisionValidUntil.assign(birds.size(), -1);
+			decisionState.assign(birds.size(), 0.0f);
+			decisionReused.assign(birds.size(), 0);
+
+			sf::FloatRect bounds = birds.at(0)->GetSprite().getLocalBounds();
+			birdReach = 0.5f * std::sqrt(bounds.width * bounds.width + bounds.height * bounds.height);
+		}
+		//The bird's scaled collision box, the same one the scoring pipes used to be checked against
+		if (!birds.empty())
+			scoreLineX = birds.at(0)->GetSprite().getPosition().x + 0.625f * 0.5f * birds.at(0)->GetSprite().getLocalBounds().width;
 
 		flash = new Flash(_data);
 		hud = new HUD(_data);
@@ -143,11 +277,48 @@ namespace Sonar
 
 		_score = 0;
 		hud->UpdateScore(_score);
+		hud->UpdateTrainingStats(generationNumber, (int)liveBirds.size(), (int)birds.size(), 0.0);
+
+		generationStart = std::chrono::steady_clock::now();
+		generationStartBirdTicks = _data->stats.birdTicks;
 
 		initialized = true;
 		_gameState = GameStates::eReady;
 	}
 
+	void GameState::LoadAssets()
+	{
+		if (!_hitSoundBuffer.loadFromFile(HIT_SOUND_FILEPATH))
+		{
+			std::cout << "Error Loading Hit Sound Effect" << std::endl;
+		}
+
+		if (!_wingSoundBuffer.loadFromFile(WING_SOUND_FILEPATH))
+		{
+			std::cout << "Error Loading Wing Sound Effect" << std::endl;
+		}
+
+		if (!_pointSoundBuffer.loadFromFile(POINT_SOUND_FILEPATH))
+		{
+			std::cout << "Error Loading Point Sound Effect" << std::endl;
+		}
+
+		_hitSound.setBuffer(_hitSoundBuffer);
+		_wingSound.setBuffer(_wingSoundBuffer);
+		_pointSound.setBuffer(_pointSoundBuffer);
+
+		this->_data->assets.LoadTexture("Game Background", GAME_BACKGROUND_FILEPATH);
+		this->_data->assets.LoadTexture("Pipe Up", PIPE_UP_FILEPATH);
+		this->_data->assets.LoadTexture("Pipe Down", PIPE_DOWN_FILEPATH);
+		this->_data->assets.LoadTexture("Land", LAND_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 1", BIRD_FRAME_1_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 2", BIRD_FRAME_2_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 3", BIRD_FRAME_3_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 4", BIRD_FRAME_4_FILEPATH);
+		this->_data->assets.LoadTexture("Scoring Pipe", SCORING_PIPE_FILEPATH);
+		this->_data->assets.LoadFont("Flappy Font", FLAPPY_FONT_FILEPATH);
+	}
+
 	void GameState::HandleInput()
 	{
 #if PLAY_WITH_AI
@@ -155,18 +326,92 @@ namespace Sonar
 		{
 			_gameState = GameStates::ePlaying;
 
-			for (auto bird : birds) {
-				if (bird->isAlive) {
-					m_pAIController->update(bird);
+			PROFILE_SCOPE("Inference");
+			//Gather every live bird's inputs, then evaluate the live population
+			int liveCount = (int)liveBirds.size();
+			_data->workers.ParallelFor(liveCount, [this](int begin, int end) {
+				for (int slot = begin; slot < end; slot++)
+				{
+					m_pAIController->gatherInputs(birds.at(liveBirds.at(slot)), &networkInputs.at(slot * NETWORK_INPUTS));
+				}
+			});
+			_data->stats.birdTicks += liveCount;
 
-					if (m_pAIController->shouldFlap())
+			if (quantizedPopulation != nullptr)
+			{
+				quantizedPopulation->Evaluate(liveBirds.data(), liveCount, networkInputs.data(), flapDecisions.data());
+				if (_data->config.validateQuantizedInference)
+				{
+					for (int slot = 0; slot < liveCount; slot++)
 					{
-						std::cout << "tap!" << std::endl;
-						bird->Tap();
-						//_wingSound.play();
+						int i = liveBirds.at(slot);
+						quantizedPopulation->RecordAgreement(flapDecisions.at(i) != 0, birds.at(i)->FindShouldFlap(&networkInputs.at(slot * NETWORK_INPUTS)));
 					}
 				}
 			}
+			else if (_data->config.analyticAdvance)
+			{
+				//A pipe spawning or leaving changes what the birds sense, every decision is taken again
+				if (pipe->GetLayoutVersion() != decisionLayoutVersion)
+				{
+					std::fill(decisionValidUntil.begin(), decisionValidUntil.end(), -1);
+					decisionLayoutVersion = pipe->GetLayoutVersion();
+				}
+				int courseStableTick = FindCourseStableTick();
+
+				_data->workers.ParallelFor(liveCount, [this, courseStableTick](int begin, int end) {
+					for (int slot = begin; slot < end; slot++)
+					{
+						int i = liveBirds.at(slot);
+						decisionReused.at(slot) = 0;
+						const float* inputs = &networkInputs.at(slot * NETWORK_INPUTS);
+						//The state input jumps rather than drifts, a new state always needs a new decision.
+						//Otherwise flapDecisions still holds the last one
+						if (generationTicks <= decisionValidUntil.at(i) && inputs[3] == decisionState.at(i))
+						{
+							decisionReused.at(slot) = 1;
+							continue;
+						}
+
+						float output = birds.at(i)->EvaluateNetwork(inputs);
+						flapDecisions.at(i) = output < 0 ? 0 : 1;
+						decisionState.at(i) = inputs[3];
+
+						//The output can't reach the boundary for as many ticks as it has room at its fastest rate
+						float room = std::abs(output) - ANALYTIC_ADVANCE_MARGIN;
+						int horizon = courseStableTick - generationTicks;
+						if (room <= 0)
+							horizon = 0;
+						else if (decisionSlope.at(i) * horizon > room)
+							horizon = (int)(room / decisionSlope.at(i));
+						decisionValidUntil.at(i) = generationTicks + horizon;
+					}
+				});
+
+				long long reused = std::count(decisionReused.begin(), decisionReused.begin() + liveCount, 1);
+				decisionsReused += reused;
+				networkEvaluations += liveCount - reused;
+			}
+			else
+			{
+				//Each bird only runs its own network
+				_data->workers.ParallelFor(liveCount, [this](int begin, int end) {
+					for (int slot = begin; slot < end; slot++)
+					{
+						int i = liveBirds.at(slot);
+						flapDecisions.at(i) = birds.at(i)->FindShouldFlap(&networkInputs.at(slot * NETWORK_INPUTS)) ? 1 : 0;
+					}
+				});
+			}
+
+			for (int i : liveBirds)
+			{
+				if (flapDecisions.at(i))
+				{
+					TapBird(i);
+					//_wingSound.play();
+				}
+			}
 		}
 
 #endif
@@ -181,15 +426,11 @@ namespace Sonar
 
 			if (this->_data->input.IsSpriteClicked(this->_background, sf::Mouse::Left, this->_data->window))
 			{
-				if (GameStates::eGameOver != _gameState)
+				if (GameStates::eGameOver != _gameState && !liveBirds.empty())
 				{
-					std::cout << "tap!" << std::endl;
 					_gameState = GameStates::ePlaying;
-					int rand = std::rand() % birds.size();
-					while(!birds.at(rand)->isAlive)
-						rand = std::rand() % birds.size();
-
-					birds.at(rand)->Tap();
+					int rand = liveBirds.at(std::rand() % liveBirds.size());
+					TapBird(rand);
 
 					//bird->Tap();
 
@@ -203,9 +444,9 @@ namespace Sonar
 	{
 		if (GameStates::eGameOver != _gameState)
 		{
-			for (auto bird : birds) {
-				if(bird->isAlive)
-					bird->Animate(dt);
+			for (int i : liveBirds)
+			{
+				birds.at(i)->Animate(dt);
 			}
 			land->MoveLand(dt);
 		}
@@ -214,7 +455,8 @@ namespace Sonar
 		{
 			pipe->MovePipes(dt);
 
-			if (clock.getElapsedTime().asSeconds() > (PIPE_SPAWN_FREQUENCY/GAME_SPEED))
+			pipeSpawnTicks++;
+			if (pipeSpawnTicks > SECONDS_TO_TICKS(PIPE_SPAWN_FREQUENCY/GAME_SPEED))
 			{
 				pipe->RandomisePipeOffset();
 
@@ -223,104 +465,182 @@ namespace Sonar
 				pipe->SpawnTopPipe();
 				pipe->SpawnScoringPipe();
 
-				clock.restart();
+				pipeSpawnTicks = 0;
 			}
-			for (auto bird : birds) {
-				bird->Update(dt);
+			{
+				PROFILE_SCOPE("Physics");
+				_data->workers.ParallelFor((int)liveBirds.size(), [this, dt](int begin, int end) {
+					for (int slot = begin; slot < end; slot++)
+					{
+						birds.at(liveBirds.at(slot))->Update(dt);
+					}
+				});
 			}
 
-			std::vector<sf::Sprite> landSprites = land->GetSprites();
-
-			for (unsigned int i = 0; i < landSprites.size(); i++)
 			{
-				for (auto bird : birds) {
-					if (bird->isAlive) {
-						if (collision.CheckSpriteCollision(bird->GetSprite(), 0.7f, landSprites.at(i), 1.0f, false))
-						{
-							if (bird->score > bird->bestScoreSoFar)
-								bird->bestScoreSoFar = bird->score;
-							bird->isAlive = false;
-							std::cout << "death" << std::endl;
-							//_gameState = GameStates::eGameOver;
-
-							//clock.restart();
+				PROFILE_SCOPE("Collision");
+				const std::vector<sf::Sprite>& landSprites = land->GetSprites();
+				const std::vector<sf::Sprite>& pipeSprites = pipe->GetSprites();
+
+				//With analytic advance, skip whatever is provably out of reach. Birds never move sideways
+				bool analyticAdvance = _data->config.analyticAdvance;
+				bool checkPipes = !analyticAdvance || IsPipeInReach();
+				float landTop = landSprites.empty() ? 0.0f : landSprites.at(0).getGlobalBounds().top;
+
+				//Birds don't interact, so each thread checks its own birds against the whole course
+				_data->workers.ParallelFor((int)liveBirds.size(), [&](int begin, int end) {
+					for (int slot = begin; slot < end; slot++)
+					{
+						int b = liveBirds.at(slot);
+						Bird* bird = birds.at(b);
 
-							//_hitSound.play();
+						bool hit = false;
+						bool checkLand = !analyticAdvance || bird->GetSprite().getPosition().y + birdReach >= landTop;
+						for (unsigned int i = 0; i < landSprites.size() && !hit && checkLand; i++)
+						{
+							hit = collision.CheckSpriteCollision(bird->GetSprite(), 0.7f, landSprites.at(i), 1.0f, false);
+						}
+						for (unsigned int i = 0; i < pipeSprites.size() && !hit && checkPipes; i++)
+						{
+							hit = collision.CheckSpriteCollision(bird->GetSprite(), 0.625f, pipeSprites.at(i), 1.0f, true);
 						}
-					}
-				}
-			}
-
-			std::vector<sf::Sprite> pipeSprites = pipe->GetSprites();
 
-			for (unsigned int i = 0; i < pipeSprites.size(); i++)
-			{
-				for (auto bird : birds) {
-					if (bird->isAlive) {
-						if (collision.CheckSpriteCollision(bird->GetSprite(), 0.625f, pipeSprites.at(i), 1.0f, true))
+						if (hit)
 						{
 							if (bird->score > bird->bestScoreSoFar)
 								bird->bestScoreSoFar = bird->score;
 							bird->isAlive = false;
-							//_gameState = GameStates::eGameOver;
-							std::cout << "death" << std::endl;
-							//clock.restart();
-
+							PROFILE_COUNT("Deaths", 1);
+							EventLog::Write(eLogInfo, eEventDeath, b, bird->score);
 							//_hitSound.play();
 						}
 					}
-				}
+				});
+				RemoveDeadBirds();
 			}
+			generationTicks++;
+
+			if (!_data->config.headless && _data->config.showTrainingStats && generationTicks % SECONDS_TO_TICKS(HUD_STATS_INTERVAL) == 0)
+			{
+				double birdTicksPerSecond = (_data->stats.birdTicks - generationStartBirdTicks) / std::max(GetGenerationSeconds(), 1e-9);
+				hud->UpdateTrainingStats(generationNumber, (int)liveBirds.size(), (int)birds.size(), birdTicksPerSecond);
+			}
+
 			//Find game over
 			if (initialized) {
-				bool dead = true;
-				for (auto bird : birds)
+				int endReason = FindEndReason();
+				if (endReason != eGenerationRunning)
 				{
-					if (bird->isAlive)
-						dead = false;
-				}
-				if (dead)
-				{
-					if (generationNumber == 0)
+					_endReason = endReason;
+					//Birds still flying when a stop condition hits keep the score they reached
+					for (int i : liveBirds)
 					{
-						ExportBirds();
+						if (birds.at(i)->score > birds.at(i)->bestScoreSoFar)
+							birds.at(i)->bestScoreSoFar = birds.at(i)->score;
 					}
-					else
+
+					if (remoteBatch)
 					{
-						#if REPLAY == false
+						std::vector<int> scores;
+						for (auto bird : birds)
+						{
+							scores.push_back(bird->score);
+						}
+						_data->remoteWorker.FinishBatch(scores);
+						this->_data->machine.AddState(new RemoteWorkerState(_data), true);
+						nextStateQueued = true;
+					}
+					else if (workerMode)
+					{
+						//Hand the scores back to the coordinator, it does everything else
+						ResultsFile results;
+						if (results.Open(_data->config.workerResults))
+						{
+							for (int i = 0; i < birds.size(); i++)
+							{
+								results.SetScore(workerFirstGenome + i, birds.at(i)->score);
+							}
+						}
+						this->_data->window.close();
+					}
+
+					if (_data->config.fitnessCache && _data->config.courseSeed != 0 && !replayMode && !workerMode)
+					{
+						//Before ExportBirds sorts the birds out of step with the hashes
+						for (int i = 0; i < birds.size(); i++)
+						{
+							if (!cachedFitness.at(i))
+								_data->fitnessCache.Store(genomeHashes.at(i), courseSeed, birds.at(i)->score);
+						}
+					}
+
+					//Also needs the birds in their original order
+					WriteReplay();
+
+					if (!replayMode && !workerMode)
+					{
+						//Before ExportBirds, the fitness goes back in the order the candidates were asked for
+						if (_data->optimizer && _data->config.optimizer != "GA" && !_data->config.neat)
+							TellOptimizer();
 						ExportBirds();
-						#endif
+						WriteProgress();
+						hud->UpdateScoreCurve();
+						WriteDiversity();
+						if (ShouldStopTraining())
+						{
+							this->_data->window.close();
+						}
+					}
+					if (quantizedPopulation != nullptr && _data->config.validateQuantizedInference)
+					{
+						std::cout << "Quantized inference agreed on " << quantizedPopulation->GetAgreementRate() * 100.0f << "% of "
+							<< quantizedPopulation->GetComparedDecisions() << " decisions ("
+							<< quantizedPopulation->GetNetworkFootprint() << " bytes per network)" << std::endl;
+					}
+					if (_data->config.analyticAdvance)
+					{
+						std::cout << "Analytic advance reused " << decisionsReused << " of " << decisionsReused + networkEvaluations << " decisions" << std::endl;
+					}
+					_data->stats.generations++;
+					EventLog::Write(eLogInfo, eEventGeneration, generationNumber, _score);
+					std::cout << "Generation " << generationNumber << ": " << EventLog::GetCount(eEventTap) << " taps, "
+						<< EventLog::GetCount(eEventDeath) << " deaths, " << generationTicks << " ticks, ended by " << endReasonNames[_endReason] << std::endl;
+					EventLog::ResetCounts();
+					if (Profiler::IsEnabled())
+					{
+						Profiler::Dump(_data->config.epochDirectory + "profile" + std::to_string(generationNumber) + ".json", std::cout);
 					}
 					_gameState = GameStates::eGameOver;
-					clock.restart();
+					gameOverTicks = 0;
+
+					if (_data->config.fastTransitions && !replayMode && !workerMode)
+					{
+						//Straight into the next generation. The highscore is all the game over screen kept
+						_data->highScore.Submit(_score);
+						this->_data->machine.AddState(new GameState(_data), true);
+						nextStateQueued = true;
+					}
 				}
 			}
 
 			if (GameStates::ePlaying == _gameState)
 			{
-				std::vector<sf::Sprite> &scoringSprites = pipe->GetScoringSprites();
-
-				for (unsigned int i = 0; i < scoringSprites.size(); i++)
+				PROFILE_SCOPE("Scoring");
+				//Every bird flies at the same x, so a live bird's score is just the columns that have reached it.
+				//Dead birds keep the score they had on the tick they died
+				int columnsPassed = pipe->CountColumnsPassed(scoreLineX);
+				if (columnsPassed != _score)
 				{
-					for (auto bird : birds) {
-						if (bird->isAlive) {
-							if (collision.CheckSpriteCollision(bird->GetSprite(), 0.625f, scoringSprites.at(i), 1.0f, false))
-							{
-								_score++;
+					_score = columnsPassed;
+					lastScoreTick = generationTicks;
 
-								hud->UpdateScore(_score);
+					hud->UpdateScore(_score);
 
-								scoringSprites.erase(scoringSprites.begin() + i);
-
-								//_pointSound.play();
-							}
-						}
-					}
+					//_pointSound.play();
 				}
-				for (auto bird : birds)
+				for (int i : liveBirds)
 				{
-					if (bird->isAlive)
-						bird->score = _score;
+					birds.at(i)->score = _score;
 				}
 			}
 		}
@@ -329,7 +649,8 @@ namespace Sonar
 		{
 			flash->Show(dt);
 
-			if (clock.getElapsedTime().asSeconds() > TIME_BEFORE_GAME_OVER_APPEARS)
+			gameOverTicks++;
+			if (gameOverTicks > SECONDS_TO_TICKS(TIME_BEFORE_GAME_OVER_APPEARS) && !nextStateQueued)
 			{
 				this->_data->machine.AddState(new GameOverState(_data, _score), true);
 			}
@@ -344,10 +665,9 @@ namespace Sonar
 
 		pipe->DrawPipes();
 		land->DrawLand();
-		for (auto bird : birds) {
-			if (bird->isAlive) {
-				bird->Draw();
-			}
+		for (int i : liveBirds)
+		{
+			birds.at(i)->Draw();
 		}
 
 		flash->Draw();
@@ -356,19 +676,131 @@ namespace Sonar
 
 		this->_data->window.display();
 	}
+	std::vector<std::vector<Node*>> GameState::CreateRandomNetwork()
+	{
+		const RunConfig& config = _data->config;
+		//Initialize the bird with random gene data
+		std::vector<std::vector<Node*>> nodeNetwork = std::vector<std::vector<Node*>>();
+
+		std::vector<Node*> inputNodes = std::vector<Node*>();
+		for (int i = 0; i < NETWORK_INPUTS; i++)
+		{
+			if (config.hiddenLayers == 0)
+				inputNodes.push_back(new InputNode(true, config.nodesPerLayer));
+			else
+				inputNodes.push_back(new InputNode(false, config.nodesPerLayer));
+		}
+		nodeNetwork.push_back(inputNodes);
+		for (int i = 0; i < config.hiddenLayers; i++)
+		{
+			std::vector<Node*> layer = std::vector<Node*>();
+			for (int j = 0; j < config.nodesPerLayer; j++)
+			{
+				if (i == config.hiddenLayers - 1)
+					layer.push_back(new ActivationNode(true, config.nodesPerLayer));
+				else
+					layer.push_back(new ActivationNode(false, config.nodesPerLayer));
+			}
+			nodeNetwork.push_back(layer);
+		}
+		return nodeNetwork;
+	}
+	Bird* GameState::CreateRandomBird()
+	{
+		if (_data->config.neat)
+			return new Bird(_data, NeatGenome::CreateMinimal());
+		return new Bird(_data, CreateRandomNetwork());
+	}
+	void GameState::AskOptimizer()
+	{
+		const RunConfig& config = _data->config;
+		std::string stateFile = config.epochDirectory + "optimizer.json";
+		std::vector<uint32_t> layerSizes;
+		std::vector<float> parameters;
+
+		if (!_data->optimizer)
+		{
+			_data->optimizer.reset(Optimizer::Create(config.optimizer, config.sigma, config.learningRate, (unsigned int)rand()));
+
+			//Centre the search on the best bird of the newest epoch, or a random one on the first generation
+			if (generationNumber > 0)
+				ImportBirds(_data, ReadEpoch(config.epochDirectory + "epoch" + std::to_string(generationNumber - 1) + ".json", 1), 1);
+			else
+				birds.push_back(CreateRandomBird());
+			PopulationFile::PackNetworks(birds, layerSizes, parameters);
+			_data->optimizer->Start(parameters);
+			for (auto bird : birds)
+			{
+				delete bird;
+			}
+			birds.clear();
+
+			//Carry on from the saved search state if it was told the newest epoch's results
+			std::ifstream stateStream(stateFile);
+			if (stateStream.is_open())
+			{
+				try
+				{
+					json stateData = json::parse(stateStream);
+					if (stateData.value("Epoch", -1) == generationNumber - 1 && _data->optimizer->FromJson(stateData, (int)parameters.size()))
+						std::cout << "Resumed " << config.optimizer << " from " << stateFile << std::endl;
+				}
+				catch (const json::exception& e)
+				{
+					std::cout << "Error Reading " << stateFile << ": " << e.what() << std::endl;
+				}
+			}
+		}
+		else
+		{
+			//Only the shape is needed, the parameters come from the optimizer
+			Bird* shape = CreateRandomBird();
+			PopulationFile::PackNetworks({ shape }, layerSizes, parameters);
+			delete shape;
+		}
+
+		for (const auto& candidate : _data->optimizer->Ask(config.populationSize))
+		{
+			birds.push_back(new Bird(_data, PopulationFile::BuildNetwork(layerSizes.data(), (int)layerSizes.size(), candidate.data())));
+		}
+	}
+	void GameState::TellOptimizer()
+	{
+		//Pipes first, then how long the bird lasted, so a generation that scores nothing still has an order.
+		//Cached and worker flown birds only have their score
+		std::vector<double> fitness(birds.size());
+		for (int i = 0; i < birds.size(); i++)
+		{
+			int lifetime = birds.at(i)->isAlive ? generationTicks : lifetimes.at(i);
+			fitness.at(i) = (double)birds.at(i)->score * 1e9 + lifetime;
+		}
+		_data->optimizer->Tell(fitness);
+
+		json stateData = _data->optimizer->ToJson();
+		stateData["Epoch"] = generationNumber;
+		std::ofstream stateFile(_data->config.epochDirectory + "optimizer.json");
+		stateFile << stateData;
+	}
 	void GameState::ExportBirds()
 	{
 		std::list<Bird*> populationAsList = std::list<Bird*>(birds.begin(), birds.end());
 		populationAsList.sort(Bird::BirdComparison);
 		birds = std::vector<Bird*>(populationAsList.begin(), populationAsList.end());
 
-		std::string epochDirectory = "epochs/";
+		std::string epochDirectory = _data->config.epochDirectory;
 		json populationData;
 
 		//iterate birds
 		for (int i = 0; i < birds.size(); i++) 
 		{
 			json geneData;
+			if (birds.at(i)->genome != nullptr)
+			{
+				geneData = birds.at(i)->genome->ToJson();
+				geneData["Score"] = birds.at(i)->bestScoreSoFar;
+				populationData["Gene" + std::to_string(i + 1)] = geneData;
+				continue;
+			}
 			geneData["Score"] = birds.at(i)->bestScoreSoFar;
 			//Iterate layers
 			for (int j = 0; j < birds.at(i)->nodeNetwork.size(); j++)
@@ -421,18 +853,246 @@ namespace Sonar
 			return;
 		outputFile << std::setw(4) << populationData;
 	}
-	void GameState::ImportBirds(GameDataRef data, json populationData)
+	void GameState::WriteProgress()
+	{
+		std::string fileName = _data->config.epochDirectory + "progress.csv";
+		bool newFile = !FileExists(fileName);
+
+		std::ofstream progressFile(fileName, std::ios::app);
+		if (!progressFile.good())
+			return;
+		if (newFile)
+			progressFile << "Generation,BestScore,MeanScore,Ticks,EndReason,MedianScore,BirdTicks,Seconds,BirdTicksPerSecond,CachedBirds" << std::endl;
+
+		std::vector<int> scores;
+		float totalScore = 0;
+		for (auto bird : birds)
+		{
+			scores.push_back(bird->bestScoreSoFar);
+			totalScore += bird->bestScoreSoFar;
+		}
+		std::sort(scores.begin(), scores.end());
+		int bestScore = scores.empty() ? 0 : scores.back();
+		float meanScore = scores.empty() ? 0.0f : totalScore / scores.size();
+		float medianScore = 0.0f;
+		if (!scores.empty())
+			medianScore = (scores.at((scores.size() - 1) / 2) + scores.at(scores.size() / 2)) / 2.0f;
+
+		double seconds = GetGenerationSeconds();
+		long long birdTicks = _data->stats.birdTicks - generationStartBirdTicks;
+
+		//Written as each generation ends, so the file can be watched while the run goes on.
+		//Workers don't send their ticks back, so those columns stay empty for the generations they flew
+		progressFile << generationNumber << "," << bestScore << "," << meanScore << ",";
+		if (!evaluatedByWorkers)
+			progressFile << generationTicks;
+		progressFile << "," << endReasonNames[_endReason] << "," << medianScore << ",";
+		if (!evaluatedByWorkers)
+			progressFile << birdTicks;
+		progressFile << "," << seconds << ",";
+		if (!evaluatedByWorkers)
+			progressFile << birdTicks / std::max(seconds, 1e-9);
+		progressFile << "," << std::count(cachedFitness.begin(), cachedFitness.end(), 1) << std::endl;
+
+		_data->stats.bestScores.push_back(bestScore);
+		_data->stats.meanScores.push_back(meanScore);
+	}
+	double GameState::GetGenerationSeconds() const
 	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - generationStart).count();
+	}
+	void GameState::WriteReplay()
+	{
+		//Workers flew this generation, there are no flap streams here
+		if (flights.empty() || evaluatedByWorkers)
+			return;
+
+		//Cached birds never flew, so they have nothing to play back
+		int champion = -1;
+		for (int i = 0; i < birds.size(); i++)
+		{
+			if (!cachedFitness.at(i) && birds.at(i)->isAlive)
+				flights.at(i).ticks = generationTicks;
+			if (cachedFitness.at(i))
+				continue;
+			if (champion == -1 || birds.at(i)->score > birds.at(champion)->score
+				|| (birds.at(i)->score == birds.at(champion)->score && flights.at(i).ticks > flights.at(champion).ticks))
+				champion = i;
+		}
+		if (champion == -1)
+			return;
+
+		Replay& replay = flights.at(champion);
+		replay.generation = generationNumber;
+		replay.courseSeed = courseSeed;
+		replay.score = birds.at(champion)->score;
+		replay.Save(_data->config.epochDirectory + "replay" + std::to_string(generationNumber) + ".json");
+	}
+	void GameState::TapBird(int index)
+	{
+		PROFILE_COUNT("Taps", 1);
+		EventLog::Write(eLogDebug, eEventTap, index, birds.at(index)->score);
+		birds.at(index)->Tap();
+		if (!flights.empty())
+			flights.at(index).SetFlap(generationTicks);
+	}
+	void GameState::WriteDiversity()
+	{
+		//The metrics compare genomes parameter by parameter, NEAT genomes don't line up that way
+		if (_data->config.neat)
+			return;
+
+		GenomeBuffer genomes;
+		std::vector<int> scores;
+		for (auto bird : birds)
+		{
+			if (genomes.AddGenome(bird->nodeNetwork))
+				scores.push_back(bird->bestScoreSoFar);
+		}
+		DiversityMetrics metrics = MeasureDiversity(genomes, scores);
+
+		json line;
+		line["Generation"] = generationNumber;
+		line["MeanPairwiseDistance"] = metrics.meanPairwiseDistance;
+		line["PairsMeasured"] = metrics.pairsMeasured;
+		line["MeanVariance"] = metrics.meanVariance;
+		line["MaxVariance"] = metrics.maxVariance;
+		line["ParameterVariance"] = metrics.parameterVariance;
+		line["UniqueGenomes"] = metrics.uniqueGenomes;
+		line["HistogramBucketWidth"] = metrics.histogramBucketWidth;
+		line["FitnessHistogram"] = metrics.fitnessHistogram;
+
+		//One object per line, so a run can be read while it is still appending
+		std::ofstream diversityFile(_data->config.epochDirectory + "diversity.ndjson", std::ios::app);
+		if (!diversityFile.good())
+			return;
+		diversityFile << line.dump() << std::endl;
+
+		std::cout << "Diversity: " << metrics.uniqueGenomes << " unique genomes, mean distance " << metrics.meanPairwiseDistance
+			<< ", mean weight variance " << metrics.meanVariance << std::endl;
+	}
+	bool GameState::ShouldStopTraining()
+	{
+		const RunConfig& config = _data->config;
+		if (config.maxGenerations > 0 && generationNumber + 1 >= config.maxGenerations)
+			return true;
+		return FileExists(config.epochDirectory + "stop");
+	}
+	int GameState::FindCourseStableTick() const
+	{
+		//Every bird sits at the same x, and every pipe scrolls by the same step each tick
+		float step = PIPE_MOVEMENT_SPEED * GAME_SPEED * TICK_DURATION;
+		float birdX = birds.at(0)->GetSprite().getPosition().x;
+
+		int stableTicks = 1 << 20;
+		for (const sf::Sprite& sprite : pipe->GetSprites())
+		{
+			//The sensors drop a pipe once its distance stops being positive. One tick of slack for rounding
+			float distance = sprite.getPosition().x - birdX;
+			if (distance > 0)
+				stableTicks = std::min(stableTicks, (int)std::ceil(distance / step) - 2);
+		}
+		return generationTicks + std::max(stableTicks, 0);
+	}
+	bool GameState::IsPipeInReach() const
+	{
+		float birdX = birds.at(0)->GetSprite().getPosition().x;
+		for (const sf::Sprite& sprite : pipe->GetSprites())
+		{
+			sf::FloatRect bounds = sprite.getGlobalBounds();
+			if (bounds.left <= birdX + birdReach && bounds.left + bounds.width >= birdX - birdReach)
+				return true;
+		}
+		return false;
+	}
+	void GameState::RemoveDeadBirds()
+	{
+		for (int slot = 0; slot < liveBirds.size();)
+		{
+			if (birds.at(liveBirds.at(slot))->isAlive)
+			{
+				slot++;
+				continue;
+			}
+			if (!flights.empty())
+				flights.at(liveBirds.at(slot)).ticks = generationTicks + 1;
+			lifetimes.at(liveBirds.at(slot)) = generationTicks + 1;
+			liveBirds.at(slot) = liveBirds.back();
+			liveBirds.pop_back();
+		}
+	}
+	int GameState::FindEndReason() const
+	{
+		const RunConfig& config = _data->config;
+
+		if (evaluatedByWorkers)
+			return eEndWorkers;
+		if (liveBirds.empty())
+			return eEndAllDead;
+		if (config.targetScore > 0 && _score >= config.targetScore)
+			return eEndTargetScore;
+		if (config.maxTicks > 0 && generationTicks >= config.maxTicks)
+			return eEndMaxTicks;
+		if (config.stagnationTicks > 0 && generationTicks - lastScoreTick >= config.stagnationTicks)
+			return eEndStagnation;
+		return eGenerationRunning;
+	}
+	json GameState::ReadEpoch(const std::string& fileName, int geneCount)
+	{
+		std::ifstream epochFile(fileName);
+		if (!epochFile.good())
+		{
+			std::cout << "Error Loading Epoch " << fileName << std::endl;
+			return json::object();
+		}
+
+		//Genes past the count are dropped as they're parsed, they're never built into the json
+		json populationData = json::parse(epochFile, [geneCount](int depth, json::parse_event_t event, json& parsed) {
+			if (depth == 1 && event == json::parse_event_t::key)
+			{
+				std::string key = parsed;
+				if (key.compare(0, 4, "Gene") == 0 && std::atoi(key.c_str() + 4) > geneCount)
+					return false;
+			}
+			return true;
+		}, false);
+		if (populationData.is_discarded())
+		{
+			std::cout << "Error Reading Epoch " << fileName << std::endl;
+			return json::object();
+		}
+		return populationData;
+	}
+	void GameState::ImportBirds(GameDataRef data, const json& populationData, int birdCount)
+	{
+		const RunConfig& config = data->config;
 		std::vector<Bird*> loadedBirds = std::vector<Bird*>();
 
 		int geneIteration = 0;
 		//iterate genes. Each iteration is a bird
 		for (const auto& gene : populationData.items())
 		{
-			//Break if loading more than population count
-			if (geneIteration >= POPULATION_SIZE)
+			//Break if loading more than requested
+			if (geneIteration >= birdCount)
 				break;
 
+			//NEAT genes keep their own topology. Training only takes the kind it evolves, replays fly either
+			bool neatGene = gene.value().contains("Connections");
+			if (neatGene != config.neat && !replayMode)
+				continue;
+			if (neatGene)
+			{
+				NeatGenome genome;
+				if (genome.FromJson(gene.value()))
+				{
+					Bird* nextBird = new Bird(data, genome);
+					nextBird->bestScoreSoFar = gene.value().value("Score", 0);
+					loadedBirds.push_back(nextBird);
+					geneIteration++;
+				}
+				continue;
+			}
+
 			int score = 0;
 			std::vector<std::vector<Node*>> nodeNetwork = std::vector<std::vector<Node*>>();
 
@@ -464,7 +1124,7 @@ namespace Sonar
 								else if (nodeData.key() == "isLast")
 									isLast = nodeData.value();
 							}
-							if(HIDDEN_LAYERS == 0)
+							if(config.hiddenLayers == 0)
 								layer.push_back(new InputNode(weights, true));
 							else
 								layer.push_back(new InputNode(weights, isLast));
@@ -477,7 +1137,7 @@ namespace Sonar
 				else if (geneData.key() == "Layer" + std::to_string(layerIteration))
 				{
 					//Break if there are more layers being loaded
-					if (layerIteration > HIDDEN_LAYERS)
+					if (layerIteration > config.hiddenLayers)
 						break;
 					std::vector<Node*> layer = std::vector<Node*>();
 					int nodeIteration = 0;
@@ -486,7 +1146,7 @@ namespace Sonar
 					{
 						std::string key = layerData.key();
 						//break if more nodes are being loaded
-						if (nodeIteration >= NODES_PER_LAYER)
+						if (nodeIteration >= config.nodesPerLayer)
 							break;
 						if (layerData.key() == "Node" + std::to_string(nodeIteration))
 						{
@@ -508,7 +1168,7 @@ namespace Sonar
 								else if (nodeData.key() == "isLast")
 									isLast = nodeData.value();
 							}
-							if(layerIteration == HIDDEN_LAYERS)
+							if(layerIteration == config.hiddenLayers)
 								layer.push_back(new ActivationNode(weights, bias, true));
 							else
 								layer.push_back(new ActivationNode(weights, bias, isLast));
@@ -516,12 +1176,12 @@ namespace Sonar
 						nodeIteration++;
 					}
 					//Initialize remaining nodes, if there are less than specified
-					for (int i = layer.size(); i < NODES_PER_LAYER; i++)
+					for (int i = layer.size(); i < config.nodesPerLayer; i++)
 					{
-						if (layerIteration == HIDDEN_LAYERS)
-							layer.push_back(new ActivationNode(true));
+						if (layerIteration == config.hiddenLayers)
+							layer.push_back(new ActivationNode(true, config.nodesPerLayer));
 						else
-							layer.push_back(new ActivationNode(isLast));
+							layer.push_back(new ActivationNode(isLast, config.nodesPerLayer));
 					}
 						
 
@@ -530,15 +1190,15 @@ namespace Sonar
 				}
 			}
 			//Initialize remaining layers, if there are less than specified
-			for (int i = nodeNetwork.size(); i <= HIDDEN_LAYERS; i++)
+			for (int i = nodeNetwork.size(); i <= config.hiddenLayers; i++)
 			{
 				std::vector<Node*> layer = std::vector<Node*>();
-				for (int j = 0; j < NODES_PER_LAYER; j++)
+				for (int j = 0; j < config.nodesPerLayer; j++)
 				{
-					if(i == HIDDEN_LAYERS)
-						layer.push_back(new ActivationNode(true));
+					if(i == config.hiddenLayers)
+						layer.push_back(new ActivationNode(true, config.nodesPerLayer));
 					else
-						layer.push_back(new ActivationNode(false));
+						layer.push_back(new ActivationNode(false, config.nodesPerLayer));
 				}
 				nodeNetwork.push_back(layer);
 			}
@@ -548,47 +1208,27 @@ namespace Sonar
 			loadedBirds.push_back(nextBird);
 			geneIteration++;
 		}
-		//Initialize remaining birds to random, if loaded birds are less than pop size
-		for (int i = loadedBirds.size(); i < POPULATION_SIZE; i++)
-		{
-			//Initialize the bird with random gene data
-			std::vector<std::vector<Node*>> _nodeNetwork = std::vector<std::vector<Node*>>();
+		//The genes come back in key order, Gene10 before Gene2. Elitism relies on the best being first
+		std::stable_sort(loadedBirds.begin(), loadedBirds.end(), Bird::BirdComparison);
 
-			std::vector<Node*> inputNodes = std::vector<Node*>();
-			for (int i = 0; i < 4; i++)
-			{
-				if(HIDDEN_LAYERS == 0)
-					inputNodes.push_back(new InputNode(true));
-				else
-					inputNodes.push_back(new InputNode(false));
-			}
-			_nodeNetwork.push_back(inputNodes);
-			for (int i = 0; i < HIDDEN_LAYERS; i++)
-			{
-				std::vector<Node*> layer = std::vector<Node*>();
-				for (int j = 0; j < NODES_PER_LAYER; j++)
-				{
-					if(i == HIDDEN_LAYERS - 1)
-						layer.push_back(new ActivationNode(true));
-					else
-						layer.push_back(new ActivationNode(false));
-				}
-				_nodeNetwork.push_back(layer);
-			}
-			loadedBirds.push_back(new Bird(data, _nodeNetwork));
+		//Initialize remaining birds to random, if loaded birds are less than requested
+		for (int i = loadedBirds.size(); i < birdCount; i++)
+		{
+			loadedBirds.push_back(CreateRandomBird());
 		}
 
 		birds = loadedBirds;
 	}
 	void GameState::Evolve(GameDataRef data)
 	{
+		const RunConfig& config = data->config;
 		//Initialize mating pool
 		std::vector<Bird*> matingPool = std::vector<Bird*>();
 		//Initialize output population
 		std::vector<Bird*> output = std::vector<Bird*>();
 
 		//Elitist selection
-		for (int i = 0; i < ELITE_SIZE; i++)
+		for (int i = 0; i < config.eliteSize; i++)
 		{
 			output.push_back(birds.at(i));
 			matingPool.push_back(birds.at(i));
@@ -619,7 +1259,7 @@ namespace Sonar
 				bestScore = bird->bestScoreSoFar;
 		}
 		//spin the wheel n times to fill the mating pool
-		while (matingPool.size() < MATING_POOL_SIZE)
+		while (matingPool.size() < config.matingPoolSize)
 		{
 			//value between 0 and sum of scores
 			int roulette = rand() % (totalScore + 1);
@@ -640,7 +1280,7 @@ namespace Sonar
 		//The mating pool has now been created, so perform crossover
 
 		//Create offspring until output population is full
-		while (output.size() < POPULATION_SIZE)
+		while (output.size() < config.populationSize)
 		{
 			//Pick 2 parents from the input population
 			Bird* parent1;
@@ -659,7 +1299,7 @@ namespace Sonar
 		//Mutate
 
 		//iterate output birds, excluding the elite
-		for (int i = ELITE_SIZE; i < output.size(); i++)
+		for (int i = config.eliteSize; i < output.size(); i++)
 		{
 			//iterate layers
 			for (int j = 0; j < output.at(i)->nodeNetwork.size(); j++)
@@ -676,7 +1316,7 @@ namespace Sonar
 						{
 							//Find if mutation happens
 							int mutation = rand() % 101;
-							if (mutation < MUTATION_RATE)
+							if (mutation < config.mutationRate)
 							{
 								//Adjust or randomize
 								int random = rand() % 10;
@@ -689,11 +1329,11 @@ namespace Sonar
 									if (random == 0)
 									{
 
-										weight += static_cast<double>(rand()) / RAND_MAX * MUTATION_ADJUSTMENT;
+										weight += static_cast<double>(rand()) / RAND_MAX * config.mutationAdjustment;
 									}
 									else
 									{
-										weight += static_cast<double>(rand()) / RAND_MAX * MUTATION_ADJUSTMENT;
+										weight += static_cast<double>(rand()) / RAND_MAX * config.mutationAdjustment;
 									}
 								}
 								else {
@@ -718,7 +1358,7 @@ namespace Sonar
 						for (int l = 0; l < node->weights.size(); l++) {
 							//Find if mutation happens on weight
 							int mutation = rand() % 101;
-							if (mutation < MUTATION_RATE)
+							if (mutation < config.mutationRate)
 							{
 								//Adjust or randomize
 								int random = rand() % 10;
@@ -731,11 +1371,11 @@ namespace Sonar
 									if (random == 0)
 									{
 
-										weight += static_cast<double>(rand()) / RAND_MAX * MUTATION_ADJUSTMENT;
+										weight += static_cast<double>(rand()) / RAND_MAX * config.mutationAdjustment;
 									}
 									else
 									{
-										weight += static_cast<double>(rand()) / RAND_MAX * MUTATION_ADJUSTMENT;
+										weight += static_cast<double>(rand()) / RAND_MAX * config.mutationAdjustment;
 									}
 								}
 								else {
@@ -748,7 +1388,7 @@ namespace Sonar
 						}
 						//Find if mutation happens on bias
 						int mutation = rand() % 101;
-						if (mutation < MUTATION_RATE)
+						if (mutation < config.mutationRate)
 						{
 							//Adjust or randomize
 							int random = rand() % 10;
@@ -760,11 +1400,11 @@ namespace Sonar
 								bias = node->bias;
 								if (random == 0)
 								{
-									bias += static_cast<double>(rand()) / RAND_MAX * MUTATION_ADJUSTMENT;
+									bias += static_cast<double>(rand()) / RAND_MAX * config.mutationAdjustment;
 								}
 								else
 								{
-									bias -= static_cast<double>(rand()) / RAND_MAX * MUTATION_ADJUSTMENT;
+									bias -= static_cast<double>(rand()) / RAND_MAX * config.mutationAdjustment;
 								}
 							}
 							else {
@@ -779,7 +1419,7 @@ namespace Sonar
 
 
 		//Delete old birds
-		for (int i = ELITE_SIZE; i < birds.size(); i++)
+		for (int i = config.eliteSize; i < birds.size(); i++)
 		{
 			if (birds.at(i) != nullptr)
 				delete birds.at(i);
@@ -816,7 +1456,7 @@ namespace Sonar
 						}
 						else
 							difference = abs(parent1Node->weights.at(k)) + abs(parent2Node->weights.at(k));
-						float adjustment = difference * CROSSOVER_RATE;
+						float adjustment = difference * data->config.crossoverRate;
 						int random = rand() % 2;
 						float weight = 0;
 						//Choose a weight from the 2 parents, and adjust it towards the other parent
@@ -864,7 +1504,7 @@ namespace Sonar
 						}
 						else
 							weightDifference = abs(parent1Node->weights.at(k)) + abs(parent2Node->weights.at(k));
-						float adjustment = weightDifference * CROSSOVER_RATE;
+						float adjustment = weightDifference * data->config.crossoverRate;
 						int random = rand() % 2;
 						float weight = 0;
 						//Choose a weight from the 2 parents, and adjust it towards the other parent
@@ -898,7 +1538,7 @@ namespace Sonar
 					}
 					else
 						biasDifference = abs(parent1Node->bias) + abs(parent2Node->bias);
-					float adjustment = biasDifference * CROSSOVER_RATE;
+					float adjustment = biasDifference * data->config.crossoverRate;
 					int random = rand() % 2;
 					float bias = 0;
 					//Choose a bias from the 2 parents, and adjust it towards the other parent
@@ -926,4 +1566,101 @@ namespace Sonar
 		}
 		return new Bird(data, nodeNetwork);
 	}
+	void GameState::EvolveNeat(GameDataRef data)
+	{
+		const RunConfig& config = data->config;
+		//Genes already in the population keep their innovation numbers
+		NeatInnovations innovations;
+		for (Bird* bird : birds)
+		{
+			innovations.Continue(*bird->genome);
+		}
+
+		//The birds are sorted best first, so every species is represented by its best bird
+		std::vector<std::vector<Bird*>> species;
+		for (Bird* bird : birds)
+		{
+			auto match = std::find_if(species.begin(), species.end(), [&](const std::vector<Bird*>& members) {
+				return NeatGenome::Distance(*members.front()->genome, *bird->genome) < config.compatibilityThreshold;
+			});
+			if (match != species.end())
+				match->push_back(bird);
+			else
+				species.push_back({ bird });
+		}
+
+		//Fitness sharing. A species earns its mean score, so one big species can't crowd out new topologies
+		std::vector<float> sharedFitness;
+		float totalFitness = 0.0f;
+		for (const auto& members : species)
+		{
+			float sum = 0.0f;
+			for (Bird* bird : members)
+			{
+				sum += bird->bestScoreSoFar + 1.0f;
+			}
+			sharedFitness.push_back(sum / members.size());
+			totalFitness += sharedFitness.back();
+		}
+
+		//Elitist selection
+		std::vector<Bird*> output = std::vector<Bird*>();
+		for (int i = 0; i < config.eliteSize; i++)
+		{
+			output.push_back(birds.at(i));
+		}
+
+		//The rounding leftovers go to the first species, it holds the best bird
+		int offspringCount = config.populationSize - (int)output.size();
+		std::vector<int> offspring;
+		int assigned = 0;
+		for (float fitness : sharedFitness)
+		{
+			offspring.push_back((int)(offspringCount * fitness / totalFitness));
+			assigned += offspring.back();
+		}
+		offspring.at(0) += offspringCount - assigned;
+
+		for (int i = 0; i < species.size(); i++)
+		{
+			//Only the better half of each species breeds
+			const std::vector<Bird*>& members = species.at(i);
+			int parentCount = std::max(1, (int)members.size() / 2);
+			for (int j = 0; j < offspring.at(i); j++)
+			{
+				int parent1Index = rand() % parentCount;
+				int parent2Index = rand() % parentCount;
+				//Members are in score order, the lower index is at least as fit
+				const NeatGenome& fitter = *members.at(std::min(parent1Index, parent2Index))->genome;
+				const NeatGenome& other = *members.at(std::max(parent1Index, parent2Index))->genome;
+				NeatGenome child = parent1Index == parent2Index ? fitter : NeatGenome::Crossover(fitter, other);
+
+				child.MutateWeights(config.mutationRate, config.mutationAdjustment);
+				if (rand() % 101 < config.addNodeRate)
+					child.MutateAddNode(innovations);
+				if (rand() % 101 < config.addConnectionRate)
+					child.MutateAddConnection(innovations);
+				if (rand() % 101 < config.removeConnectionRate)
+					child.MutateRemoveConnection();
+				output.push_back(new Bird(data, child));
+			}
+		}
+
+		long long instructions = 0;
+		for (Bird* bird : output)
+		{
+			instructions += static_cast<NeatNetwork*>(bird->compiledNetwork)->GetInstructionCount();
+		}
+		std::cout << "NEAT: " << species.size() << " species, " << (float)instructions / output.size() << " instructions per network" << std::endl;
+
+		//Delete old birds
+		for (int i = config.eliteSize; i < birds.size(); i++)
+		{
+			if (birds.at(i) != nullptr)
+				delete birds.at(i);
+		}
+		birds.clear();
+
+		birds = output;
+	}
 }
\ No newline at end of file
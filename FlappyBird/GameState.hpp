@@ -2,6 +2,7 @@
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <chrono>
 #include <fstream>
 #include <string>
 
@@ -13,6 +14,9 @@
 #include "Collision.hpp"
 #include "Flash.hpp"
 #include "HUD.hpp"
+#include "QuantizedNetwork.h"
+#include "Diversity.h"
+#include "Replay.hpp"
 
 //library for json files, namepspace definition
 #include "nlohmann/json.hpp"
@@ -24,6 +28,9 @@ namespace Sonar
 {
 	class GameState : public State
 	{
+		//Builds fixtures out of the private training steps
+		friend class Benchmark;
+
 	public:
 		GameState(GameDataRef data);
 		~GameState() override;
@@ -39,28 +46,67 @@ namespace Sonar
 		std::vector<Bird*> GetBirds() { return birds; }
 
 	private:
+		//Loads the sounds and textures used by the game, the birds and the pipes
+		void LoadAssets();
+		//Creates a network with random weights, shaped by the run config
+		std::vector<std::vector<Node*>> CreateRandomNetwork();
+		//A bird with a random network, or a minimal NEAT genome in NEAT mode
+		Bird* CreateRandomBird();
 		//Saves the bird list to a json file
 		void ExportBirds();
-		//Imports the bird list from a json file
-		void ImportBirds(GameDataRef data, json populationData);
+		//Appends the generation's scores, ticks, throughput and fitness cache hits to progress.csv in the epoch directory,
+		//and to the score history the HUD draws
+		void WriteProgress();
+		//Wall time since Init finished
+		double GetGenerationSeconds() const;
+		//Saves the flight of the bird that scored highest this generation, the longest lived one on a tie
+		void WriteReplay();
+		//Taps a bird and records the flap for its replay
+		void TapBird(int index);
+		//Appends the generation's diversity metrics to diversity.ndjson in the epoch directory
+		void WriteDiversity();
+		//True once the run has trained enough generations or a sweep asked it to stop
+		bool ShouldStopTraining();
+		//Which stop condition ends the generation this tick, eGenerationRunning if none
+		int FindEndReason() const;
+		//Last tick before a pipe sprite passes the birds and the nearest pipes they sense change
+		int FindCourseStableTick() const;
+		//True if a pipe is close enough horizontally for any bird to touch it this tick
+		bool IsPipeInReach() const;
+		//Swap-removes the birds that died this tick from liveBirds
+		void RemoveDeadBirds();
+		//Imports up to birdCount birds from an epoch, best first, and fills the rest of the population with random ones
+		void ImportBirds(GameDataRef data, const json& populationData, int birdCount);
+		//Parses an epoch file, keeping only Gene1 to Gene<geneCount>. Exports are sorted best first, so those are the best birds
+		static json ReadEpoch(const std::string& fileName, int geneCount);
 		
 		//Evolves the bird list and creates the next generation
 		void Evolve(GameDataRef data);
 		Bird* Crossover(GameDataRef data, Bird* parent1, Bird* parent2);
+		//NEAT version. Splits the birds into species, shares fitness within each species, and breeds every species
+		//in proportion to its shared fitness with structural mutations on top of the weight ones
+		void EvolveNeat(GameDataRef data);
+		//Fills the population with the ES or CMA-ES optimizer's candidates. The optimizer starts on the newest epoch's
+		//best bird, or carries on from optimizer.json in the epoch directory when that was saved after the newest epoch
+		void AskOptimizer();
+		//Hands the generation's fitness back to the optimizer in the order it was asked, and saves its state
+		void TellOptimizer();
 
 		GameDataRef _data;
 
 		sf::Sprite _background;
 
-		Pipe *pipe;
-		Land *land;
+		Pipe *pipe = nullptr;
+		Land *land = nullptr;
 		std::vector<Bird*> birds;
 		//Bird *bird;
 		Collision collision;
-		Flash *flash;
-		HUD *hud;
+		Flash *flash = nullptr;
+		HUD *hud = nullptr;
 
-		sf::Clock clock;
+		//Ticks since the last pipe spawned, and since the generation ended
+		int pipeSpawnTicks = 0;
+		int gameOverTicks = 0;
 
 		int _gameState;
 
@@ -68,8 +114,17 @@ namespace Sonar
 		bool _flashOn;
 
 		int _score;
+		//A column counts as passed once its scoring pipe reaches this x
+		float scoreLineX = 0.0f;
 
 		int generationNumber = -1;
+		//Ticks played this generation, and the tick the score last went up
+		int generationTicks = 0;
+		int lastScoreTick = 0;
+		int _endReason = eGenerationRunning;
+		//When Init finished, and the bird tick total at that point
+		std::chrono::steady_clock::time_point generationStart;
+		long long generationStartBirdTicks = 0;
 
 		sf::SoundBuffer _hitSoundBuffer;
 		sf::SoundBuffer _wingSoundBuffer;
@@ -81,6 +136,56 @@ namespace Sonar
 
 		AIController* m_pAIController;
 
+		//Indices of the birds still flying, in no particular order. Dead birds are swap-removed so every
+		//per tick loop only walks the live ones.
+		//There's no separate position/velocity array: a bird's position and rotation live in its sf::Sprite,
+		//which the collision test reads through its transform, and its speed is a constant picked by its state.
+		//Mirroring them would add a copy back into the sprite every tick, for loops that are dominated by
+		//CheckSpriteCollision anyway
+		std::vector<int> liveBirds;
+
+		//Seed of this generation's pipe course
+		unsigned int courseSeed = 0;
+		//Per bird fitness cache keys, and whether the score came from the cache instead of flying
+		std::vector<uint64_t> genomeHashes;
+		std::vector<unsigned char> cachedFitness;
+		//Tick each bird died on, the optimizers break score ties with it
+		std::vector<int> lifetimes;
+
+		//Flap streams of every bird that flies this generation, only kept when replays are recorded
+		std::vector<Replay> flights;
+
+		//Reduced precision copy of the population, only built when the inference mode isn't INFERENCE_FLOAT
+		QuantizedPopulation* quantizedPopulation = nullptr;
+		//NETWORK_INPUTS floats per entry of liveBirds, in the same order
+		std::vector<float> networkInputs;
+		//Indexed by bird
+		std::vector<unsigned char> flapDecisions;
+
+		//Analytic advance. How fast each bird's output can move per tick, and how long its last decision holds
+		std::vector<float> decisionSlope;
+		std::vector<int> decisionValidUntil;
+		std::vector<float> decisionState;
+		//Indexed like networkInputs
+		std::vector<unsigned char> decisionReused;
+		int decisionLayoutVersion = -1;
+		long long networkEvaluations = 0;
+		long long decisionsReused = 0;
+		//Half diagonal of the bird sprite, it bounds the collision box at any rotation
+		float birdReach = 0.0f;
+
 		bool initialized = false;
+		//Flying the top birds of an old epoch, nothing is evolved or written
+		bool replayMode = false;
+		//Flying a share of a coordinator's population file, only the scores are written back
+		bool workerMode = false;
+		//Index in the population file of this worker's first bird
+		int workerFirstGenome = 0;
+		//Every bird's score came from worker processes
+		bool evaluatedByWorkers = false;
+		//Flying a batch a coordinator sent over the network, the scores go back over the same connection
+		bool remoteBatch = false;
+		//The generation ended straight into the next state, there's no game over screen to wait for
+		bool nextStateQueued = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include "DEFINITIONS.hpp"
+
+//FNV-1a over 64 bit values. The fitness cache, the diversity metrics and NEAT genomes all hash through this,
+//so a genome rounds and hashes the same way wherever it's looked up
+class GenomeHash
+{
+public:
+	void Mix(int64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			hash ^= (uint64_t)(value >> (i * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	}
+	//Weights and biases closer together than FITNESS_CACHE_QUANTUM hash the same
+	void MixParameter(float value) { Mix((int64_t)std::llround(value / FITNESS_CACHE_QUANTUM)); }
+
+	uint64_t Get() const { return hash; }
+
+private:
+	uint64_t hash = 14695981039346656037ull;
+};
@@ -1,7 +1,16 @@
 #include "HUD.hpp"
 
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <string>
 
+//Score curve box in the top left corner, under the stats text
+#define CURVE_LEFT 10.0f
+#define CURVE_TOP 90.0f
+#define CURVE_WIDTH 200.0f
+#define CURVE_HEIGHT 80.0f
+
 namespace Sonar
 {
 	HUD::HUD(GameDataRef data) : _data(data)
@@ -17,6 +26,21 @@ namespace Sonar
 		_scoreText.setOrigin(sf::Vector2f(_scoreText.getGlobalBounds().width / 2, _scoreText.getGlobalBounds().height / 2));
 
 		_scoreText.setPosition(sf::Vector2f((float)_data->window.getSize().x / 2, (float)_data->window.getSize().y / 5));
+
+		_statsText.setFont(this->_data->assets.GetFont("Flappy Font"));
+		_statsText.setCharacterSize(20);
+		_statsText.setFillColor(sf::Color::White);
+		_statsText.setOutlineColor(sf::Color::Black);
+		_statsText.setOutlineThickness(1.0f);
+		_statsText.setPosition(sf::Vector2f(CURVE_LEFT, 10.0f));
+
+		_curveBackground.setPosition(sf::Vector2f(CURVE_LEFT, CURVE_TOP));
+		_curveBackground.setSize(sf::Vector2f(CURVE_WIDTH, CURVE_HEIGHT));
+		_curveBackground.setFillColor(sf::Color(0, 0, 0, 96));
+		_bestCurve.setPrimitiveType(sf::LineStrip);
+		_meanCurve.setPrimitiveType(sf::LineStrip);
+
+		UpdateScoreCurve();
 	}
 
 	HUD::~HUD()
@@ -26,10 +50,56 @@ namespace Sonar
 	void HUD::Draw()
 	{
 		_data->window.draw(_scoreText);
+
+		if (_data->config.showTrainingStats)
+		{
+			_data->window.draw(_statsText);
+			if (_bestCurve.getVertexCount() > 1)
+			{
+				_data->window.draw(_curveBackground);
+				_data->window.draw(_meanCurve);
+				_data->window.draw(_bestCurve);
+			}
+		}
 	}
 
 	void HUD::UpdateScore(int score)
 	{
 		_scoreText.setString(std::to_string(score));
 	}
+
+	void HUD::UpdateTrainingStats(int generation, int liveBirds, int population, double birdTicksPerSecond)
+	{
+		const std::vector<int>& bestScores = _data->stats.bestScores;
+		std::ostringstream text;
+		text << "Generation " << generation << "\n"
+			<< "Alive " << liveBirds << "/" << population << "\n"
+			<< "Last best " << (bestScores.empty() ? 0 : bestScores.back()) << "   " << std::fixed << std::setprecision(0) << birdTicksPerSecond << " ticks/s";
+		_statsText.setString(text.str());
+	}
+
+	void HUD::UpdateScoreCurve()
+	{
+		const std::vector<int>& bestScores = _data->stats.bestScores;
+		const std::vector<float>& meanScores = _data->stats.meanScores;
+		int first = std::max(0, (int)bestScores.size() - HUD_CURVE_POINTS);
+		int count = (int)bestScores.size() - first;
+
+		int highest = 1;
+		for (int i = first; i < (int)bestScores.size(); i++)
+		{
+			highest = std::max(highest, bestScores.at(i));
+		}
+
+		_bestCurve.resize(count);
+		_meanCurve.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			float x = CURVE_LEFT + (count > 1 ? CURVE_WIDTH * i / (count - 1) : 0.0f);
+			_bestCurve[i].position = sf::Vector2f(x, CURVE_TOP + CURVE_HEIGHT * (1.0f - (float)bestScores.at(first + i) / highest));
+			_bestCurve[i].color = sf::Color::Yellow;
+			_meanCurve[i].position = sf::Vector2f(x, CURVE_TOP + CURVE_HEIGHT * (1.0f - meanScores.at(first + i) / highest));
+			_meanCurve[i].color = sf::Color::Cyan;
+		}
+	}
 }
\ No newline at end of file
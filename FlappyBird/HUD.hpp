@@ -16,10 +16,20 @@ namespace Sonar
 		void Draw();
 		void UpdateScore(int score);
 
+		//Training overlay. The text is cheap to draw but slow to lay out, so only update it every HUD_STATS_INTERVAL
+		void UpdateTrainingStats(int generation, int liveBirds, int population, double birdTicksPerSecond);
+		//Rebuilds the curve from the last HUD_CURVE_POINTS generations of the TrainingStats
+		void UpdateScoreCurve();
+
 	private:
 		GameDataRef _data;
 
 		sf::Text _scoreText;
 
+		sf::Text _statsText;
+		sf::RectangleShape _curveBackground;
+		sf::VertexArray _bestCurve;
+		sf::VertexArray _meanCurve;
+
 	};
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "HeadlessEvaluator.hpp"
+#include "PopulationFile.hpp"
+#include "Process.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace Sonar
+{
+	HeadlessEvaluator::HeadlessEvaluator(const RunConfig& config) : _workerConfig(config), _workerCount(config.workers)
+	{
+		_directory = config.epochDirectory + "workers/";
+
+		//Workers only fly, anything that would start another mode or more workers is cleared
+		_workerConfig.headless = true;
+		_workerConfig.workers = 0;
+		_workerConfig.workerPopulation = _directory + "population.bin";
+		_workerConfig.workerResults = _directory + "results.bin";
+		_workerConfig.workerCount = _workerCount;
+		_workerConfig.epochDirectory = _directory;
+		_workerConfig.maxGenerations = 0;
+		_workerConfig.sweepFile = "";
+		_workerConfig.benchmarkFile = "";
+		_workerConfig.throughputFile = "";
+		_workerConfig.statsFile = "";
+		_workerConfig.replayFile = "";
+		_workerConfig.replayEpoch = "";
+		_workerConfig.profile = false;
+	}
+
+	bool HeadlessEvaluator::Evaluate(const std::vector<Bird*>& birds, unsigned int courseSeed, int generation, std::vector<int>& scores)
+	{
+		CreateDirectories(_directory);
+		if (!PopulationFile::Write(_workerConfig.workerPopulation, birds, courseSeed, generation)
+			|| !ResultsFile::Create(_workerConfig.workerResults, (int)birds.size()))
+			return false;
+
+		std::ofstream configFile(_directory + "config.json");
+		configFile << std::setw(4) << _workerConfig.ToJson();
+		configFile.close();
+
+		//More workers than birds would leave some with nothing to fly
+		int workerCount = std::min(_workerCount, (int)birds.size());
+		std::vector<std::thread> workers;
+		for (int i = 0; i < workerCount; i++)
+		{
+			workers.push_back(std::thread([this, i, workerCount]() {
+				RunProcess(_workerConfig.executable, { "--config", _directory + "config.json",
+					"--worker-index", std::to_string(i), "--worker-count", std::to_string(workerCount) });
+			}));
+		}
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		ResultsFile results;
+		if (!results.Open(_workerConfig.workerResults) || results.GetGenomeCount() != (int)birds.size())
+			return false;
+		scores.assign(birds.size(), 0);
+		for (int i = 0; i < (int)birds.size(); i++)
+		{
+			if (results.GetScore(i) < 0)
+				return false;
+			scores.at(i) = results.GetScore(i);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RunConfig.hpp"
+#include "Bird.hpp"
+
+namespace Sonar
+{
+	//Flies a generation in headless worker processes instead of this one. The genomes are written once to a binary
+	//population file that every worker maps read-only, and each worker writes its birds' scores into a shared results file
+	class HeadlessEvaluator
+	{
+	public:
+		HeadlessEvaluator(const RunConfig& config);
+
+		//scores gets one entry per bird. Returns false if any worker didn't report all of its birds
+		bool Evaluate(const std::vector<Bird*>& birds, unsigned int courseSeed, int generation, std::vector<int>& scores);
+
+	private:
+		RunConfig _workerConfig;
+		int _workerCount;
+		std::string _directory;
+	};
+}
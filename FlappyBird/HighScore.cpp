@@ -0,0 +1,52 @@
+#include "HighScore.hpp"
+#include "DEFINITIONS.hpp"
+
+#include <fstream>
+
+namespace Sonar
+{
+	int HighScore::Get()
+	{
+		Load();
+		return _score;
+	}
+
+	void HighScore::Submit(int score)
+	{
+		Load();
+		if (score > _score)
+		{
+			_score = score;
+			_changed = true;
+		}
+
+		_unflushedScores++;
+		if (_unflushedScores >= HIGHSCORE_FLUSH_INTERVAL)
+			Flush();
+	}
+
+	void HighScore::Flush()
+	{
+		_unflushedScores = 0;
+		if (!_changed)
+			return;
+
+		std::ofstream writeFile(HIGHSCORE_FILEPATH);
+		if (writeFile.is_open())
+		{
+			writeFile << _score;
+			_changed = false;
+		}
+	}
+
+	void HighScore::Load()
+	{
+		if (_loaded)
+			return;
+		_loaded = true;
+
+		std::ifstream readFile(HIGHSCORE_FILEPATH);
+		if (readFile.is_open())
+			readFile >> _score;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Sonar
+{
+	//Best score across runs. Read from the highscore file on first use, then kept in memory and only written back
+	//every HIGHSCORE_FLUSH_INTERVAL new scores and when the game closes
+	class HighScore
+	{
+	public:
+		int Get();
+		void Submit(int score);
+		//Writes the highscore file if the score changed since the last write
+		void Flush();
+
+	private:
+		void Load();
+
+		int _score = 0;
+		bool _loaded = false;
+		bool _changed = false;
+		int _unflushedScores = 0;
+	};
+}
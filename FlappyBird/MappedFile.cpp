@@ -0,0 +1,88 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Sonar
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& fileName, bool writable)
+	{
+		Close();
+#ifdef _WIN32
+		_file = CreateFileA(fileName.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (_file == INVALID_HANDLE_VALUE)
+		{
+			_file = nullptr;
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+		_size = (size_t)size.QuadPart;
+		_mapping = CreateFileMappingA(_file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+		if (_mapping == nullptr)
+		{
+			Close();
+			return false;
+		}
+		_data = (char*)MapViewOfFile(_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+#else
+		_file = open(fileName.c_str(), writable ? O_RDWR : O_RDONLY);
+		if (_file < 0)
+			return false;
+		struct stat status;
+		if (fstat(_file, &status) != 0 || status.st_size == 0)
+		{
+			Close();
+			return false;
+		}
+		_size = (size_t)status.st_size;
+		void* data = mmap(nullptr, _size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, _file, 0);
+		_data = data == MAP_FAILED ? nullptr : (char*)data;
+#endif
+		if (_data == nullptr)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (_data != nullptr)
+			UnmapViewOfFile(_data);
+		if (_mapping != nullptr)
+			CloseHandle(_mapping);
+		if (_file != nullptr)
+			CloseHandle(_file);
+		_mapping = nullptr;
+		_file = nullptr;
+#else
+		if (_data != nullptr)
+			munmap(_data, _size);
+		if (_file >= 0)
+			close(_file);
+		_file = -1;
+#endif
+		_data = nullptr;
+		_size = 0;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Sonar
+{
+	//A whole file mapped into memory. Read-only maps of the same file share their pages between processes,
+	//and writes through a writable map are seen by every other process mapping it
+	class MappedFile
+	{
+	public:
+		MappedFile() { }
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& fileName, bool writable);
+		void Close();
+
+		char* GetData() const { return _data; }
+		size_t GetSize() const { return _size; }
+
+	private:
+		char* _data = nullptr;
+		size_t _size = 0;
+#ifdef _WIN32
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#else
+		int _file = -1;
+#endif
+	};
+}
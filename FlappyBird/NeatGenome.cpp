@@ -0,0 +1,494 @@
+#include "NeatGenome.h"
+#include "Activation.h"
+#include "GenomeHash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+
+//Random node pairs tried before an add connection mutation gives up
+#define NEAT_CONNECTION_ATTEMPTS 20
+
+namespace
+{
+	float RandomWeight()
+	{
+		float weight = 0;
+		while (std::abs(weight) < 0.0001f) {
+			weight = -WEIGHT_MAX + ((float)rand() / ((float)RAND_MAX / (WEIGHT_MAX - -WEIGHT_MAX)));
+		}
+		return weight;
+	}
+
+	void MutateValue(float& value, int mutationRate, float mutationAdjustment)
+	{
+		//Find if mutation happens
+		if (rand() % 101 >= mutationRate)
+			return;
+		//Adjust or randomize
+		if (rand() % 10 <= 8)
+		{
+			float adjustment = static_cast<float>(rand()) / RAND_MAX * mutationAdjustment;
+			value += rand() % 2 == 0 ? adjustment : -adjustment;
+		}
+		else
+			value = RandomWeight();
+	}
+}
+
+void NeatInnovations::Continue(const NeatGenome& genome)
+{
+	for (const auto& connection : genome.connections)
+	{
+		connections[std::make_pair(connection.from, connection.to)] = connection.innovation;
+		nextInnovation = std::max(nextInnovation, connection.innovation + 1);
+	}
+	for (const auto& node : genome.nodes)
+	{
+		nextNode = std::max(nextNode, node.id + 1);
+	}
+}
+
+int NeatInnovations::GetConnectionInnovation(int from, int to)
+{
+	auto connection = connections.find(std::make_pair(from, to));
+	if (connection != connections.end())
+		return connection->second;
+	connections[std::make_pair(from, to)] = nextInnovation;
+	return nextInnovation++;
+}
+
+int NeatInnovations::GetSplitNode(int innovation)
+{
+	auto node = splitNodes.find(innovation);
+	if (node != splitNodes.end())
+		return node->second;
+	splitNodes[innovation] = nextNode;
+	return nextNode++;
+}
+
+NeatGenome NeatGenome::CreateMinimal()
+{
+	NeatGenome genome;
+	for (int i = 0; i < NETWORK_INPUTS; i++)
+	{
+		genome.nodes.push_back({ i, eNeatInput, 0.0f });
+	}
+	genome.nodes.push_back({ NETWORK_INPUTS, eNeatOutput, 0.0f });
+	for (int i = 0; i < NETWORK_INPUTS; i++)
+	{
+		genome.connections.push_back({ i, i, NETWORK_INPUTS, RandomWeight(), true });
+	}
+	return genome;
+}
+
+NeatGenome NeatGenome::Crossover(const NeatGenome& fitter, const NeatGenome& other)
+{
+	NeatGenome child = fitter;
+
+	//Both lists are sorted by innovation, walk them together
+	int j = 0;
+	for (auto& gene : child.connections)
+	{
+		while (j < (int)other.connections.size() && other.connections.at(j).innovation < gene.innovation)
+			j++;
+		if (j == (int)other.connections.size() || other.connections.at(j).innovation != gene.innovation)
+			continue;
+
+		const NeatConnectionGene& match = other.connections.at(j);
+		if (rand() % 2 == 0)
+			gene.weight = match.weight;
+		//A gene disabled in either parent usually stays disabled
+		if (!gene.enabled || !match.enabled)
+			gene.enabled = rand() % 4 == 0;
+	}
+
+	for (auto& node : child.nodes)
+	{
+		const NeatNodeGene* match = other.FindNode(node.id);
+		if (match != nullptr && rand() % 2 == 0)
+			node.bias = match->bias;
+	}
+	return child;
+}
+
+float NeatGenome::Distance(const NeatGenome& first, const NeatGenome& second)
+{
+	int matching = 0;
+	float weightDifference = 0.0f;
+	int i = 0, j = 0;
+	while (i < (int)first.connections.size() && j < (int)second.connections.size())
+	{
+		int firstInnovation = first.connections.at(i).innovation;
+		int secondInnovation = second.connections.at(j).innovation;
+		if (firstInnovation == secondInnovation)
+		{
+			weightDifference += std::abs(first.connections.at(i).weight - second.connections.at(j).weight);
+			matching++;
+			i++;
+			j++;
+		}
+		else if (firstInnovation < secondInnovation)
+			i++;
+		else
+			j++;
+	}
+
+	//Disjoint and excess genes weigh the same here
+	int mismatched = (int)(first.connections.size() + second.connections.size()) - 2 * matching;
+	float geneCount = (float)std::max<size_t>(std::max(first.connections.size(), second.connections.size()), 1);
+	float distance = NEAT_DISJOINT_COEFFICIENT * mismatched / geneCount;
+	if (matching > 0)
+		distance += NEAT_WEIGHT_COEFFICIENT * weightDifference / matching;
+	return distance;
+}
+
+void NeatGenome::MutateWeights(int mutationRate, float mutationAdjustment)
+{
+	for (auto& connection : connections)
+	{
+		MutateValue(connection.weight, mutationRate, mutationAdjustment);
+	}
+	for (auto& node : nodes)
+	{
+		if (node.type != eNeatInput)
+			MutateValue(node.bias, mutationRate, mutationAdjustment);
+	}
+}
+
+void NeatGenome::MutateAddConnection(NeatInnovations& innovations)
+{
+	for (int attempt = 0; attempt < NEAT_CONNECTION_ATTEMPTS; attempt++)
+	{
+		const NeatNodeGene& from = nodes.at(rand() % nodes.size());
+		const NeatNodeGene& to = nodes.at(rand() % nodes.size());
+		if (from.type == eNeatOutput || to.type == eNeatInput)
+			continue;
+
+		auto existing = std::find_if(connections.begin(), connections.end(), [&](const NeatConnectionGene& connection) {
+			return connection.from == from.id && connection.to == to.id;
+		});
+		if (existing != connections.end())
+		{
+			//Turning a disabled gene back on never makes a loop, every gene counts when looking for one
+			if (existing->enabled)
+				continue;
+			existing->enabled = true;
+			return;
+		}
+		if (CreatesCycle(from.id, to.id))
+			continue;
+
+		AddConnection({ innovations.GetConnectionInnovation(from.id, to.id), from.id, to.id, RandomWeight(), true });
+		return;
+	}
+}
+
+void NeatGenome::MutateAddNode(NeatInnovations& innovations)
+{
+	std::vector<int> enabled;
+	for (int i = 0; i < (int)connections.size(); i++)
+	{
+		if (connections.at(i).enabled)
+			enabled.push_back(i);
+	}
+	if (enabled.empty())
+		return;
+
+	NeatConnectionGene split = connections.at(enabled.at(rand() % enabled.size()));
+	int node = innovations.GetSplitNode(split.innovation);
+	//This genome already split the connection once, and has since turned it back on
+	if (FindNode(node) != nullptr)
+		return;
+
+	//The new node starts out passing the signal through, so the network barely changes
+	for (auto& connection : connections)
+	{
+		if (connection.innovation == split.innovation)
+			connection.enabled = false;
+	}
+	AddNode({ node, eNeatHidden, 0.0f });
+	AddConnection({ innovations.GetConnectionInnovation(split.from, node), split.from, node, 1.0f, true });
+	AddConnection({ innovations.GetConnectionInnovation(node, split.to), node, split.to, split.weight, true });
+}
+
+void NeatGenome::MutateRemoveConnection()
+{
+	std::vector<int> enabled;
+	for (int i = 0; i < (int)connections.size(); i++)
+	{
+		if (connections.at(i).enabled)
+			enabled.push_back(i);
+	}
+	if (enabled.empty())
+		return;
+	connections.erase(connections.begin() + enabled.at(rand() % enabled.size()));
+
+	nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [this](const NeatNodeGene& node) {
+		if (node.type != eNeatHidden)
+			return false;
+		return std::none_of(connections.begin(), connections.end(), [&node](const NeatConnectionGene& connection) {
+			return connection.from == node.id || connection.to == node.id;
+		});
+	}), nodes.end());
+}
+
+int NeatGenome::GetEnabledConnectionCount() const
+{
+	return (int)std::count_if(connections.begin(), connections.end(), [](const NeatConnectionGene& connection) { return connection.enabled; });
+}
+
+void NeatGenome::GetInputSensitivity(float* sensitivity) const
+{
+	std::vector<int> order = GetTopologicalOrder();
+	for (int input = 0; input < NETWORK_INPUTS; input++)
+	{
+		std::map<int, float> nodeSensitivity;
+		nodeSensitivity[input] = 1.0f;
+		for (int id : order)
+		{
+			if (FindNode(id)->type == eNeatInput)
+				continue;
+			float sum = 0.0f;
+			for (const auto& connection : connections)
+			{
+				if (connection.enabled && connection.to == id)
+					sum += nodeSensitivity[connection.from] * std::abs(connection.weight);
+			}
+			nodeSensitivity[id] = sum;
+		}
+		sensitivity[input] = nodeSensitivity[NETWORK_INPUTS];
+	}
+}
+
+uint64_t NeatGenome::GetHash() const
+{
+	GenomeHash hash;
+	for (const auto& node : nodes)
+	{
+		hash.Mix(node.id);
+		hash.Mix(node.type);
+		hash.MixParameter(node.bias);
+	}
+	for (const auto& connection : connections)
+	{
+		hash.Mix(connection.from);
+		hash.Mix(connection.to);
+		hash.Mix(connection.enabled ? 1 : 0);
+		hash.MixParameter(connection.weight);
+	}
+	return hash.Get();
+}
+
+nlohmann::json NeatGenome::ToJson() const
+{
+	nlohmann::json data;
+	data["Nodes"] = nlohmann::json::array();
+	for (const auto& node : nodes)
+	{
+		nlohmann::json nodeData;
+		nodeData["Id"] = node.id;
+		nodeData["Type"] = node.type;
+		nodeData["Bias"] = node.bias;
+		data["Nodes"].push_back(nodeData);
+	}
+	data["Connections"] = nlohmann::json::array();
+	for (const auto& connection : connections)
+	{
+		nlohmann::json connectionData;
+		connectionData["Innovation"] = connection.innovation;
+		connectionData["From"] = connection.from;
+		connectionData["To"] = connection.to;
+		connectionData["Weight"] = connection.weight;
+		connectionData["Enabled"] = connection.enabled;
+		data["Connections"].push_back(connectionData);
+	}
+	return data;
+}
+
+bool NeatGenome::FromJson(const nlohmann::json& data)
+{
+	nodes.clear();
+	connections.clear();
+	try
+	{
+		for (const auto& nodeData : data.at("Nodes"))
+		{
+			AddNode({ nodeData.at("Id").get<int>(), nodeData.at("Type").get<int>(), nodeData.at("Bias").get<float>() });
+		}
+		for (const auto& connectionData : data.at("Connections"))
+		{
+			AddConnection({ connectionData.at("Innovation").get<int>(), connectionData.at("From").get<int>(),
+				connectionData.at("To").get<int>(), connectionData.at("Weight").get<float>(), connectionData.at("Enabled").get<bool>() });
+		}
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		std::cout << "Error Reading NEAT Genome: " << e.what() << std::endl;
+		return false;
+	}
+
+	//The inputs and the output have fixed ids, and every connection has to run between known nodes without a loop
+	for (int i = 0; i <= NETWORK_INPUTS; i++)
+	{
+		const NeatNodeGene* node = FindNode(i);
+		if (node == nullptr || node->type != (i < NETWORK_INPUTS ? eNeatInput : eNeatOutput))
+			return false;
+	}
+	for (const auto& connection : connections)
+	{
+		if (FindNode(connection.from) == nullptr || FindNode(connection.to) == nullptr)
+			return false;
+	}
+	return GetTopologicalOrder().size() == nodes.size();
+}
+
+std::vector<int> NeatGenome::GetTopologicalOrder() const
+{
+	std::map<int, int> incoming;
+	for (const auto& node : nodes)
+	{
+		incoming[node.id] = 0;
+	}
+	for (const auto& connection : connections)
+	{
+		incoming[connection.to]++;
+	}
+
+	//Kahn's algorithm, taking ready nodes lowest id first
+	std::set<int> ready;
+	for (const auto& node : incoming)
+	{
+		if (node.second == 0)
+			ready.insert(node.first);
+	}
+	std::vector<int> order;
+	while (!ready.empty())
+	{
+		int id = *ready.begin();
+		ready.erase(ready.begin());
+		order.push_back(id);
+		for (const auto& connection : connections)
+		{
+			if (connection.from == id && --incoming[connection.to] == 0)
+				ready.insert(connection.to);
+		}
+	}
+	//Shorter than nodes if there is a loop
+	return order;
+}
+
+bool NeatGenome::CreatesCycle(int from, int to) const
+{
+	if (from == to)
+		return true;
+	std::vector<int> stack = { to };
+	std::set<int> visited;
+	while (!stack.empty())
+	{
+		int id = stack.back();
+		stack.pop_back();
+		if (id == from)
+			return true;
+		if (!visited.insert(id).second)
+			continue;
+		for (const auto& connection : connections)
+		{
+			if (connection.from == id)
+				stack.push_back(connection.to);
+		}
+	}
+	return false;
+}
+
+const NeatNodeGene* NeatGenome::FindNode(int id) const
+{
+	auto node = std::lower_bound(nodes.begin(), nodes.end(), id, [](const NeatNodeGene& node, int id) { return node.id < id; });
+	if (node == nodes.end() || node->id != id)
+		return nullptr;
+	return &*node;
+}
+
+void NeatGenome::AddNode(const NeatNodeGene& node)
+{
+	auto position = std::lower_bound(nodes.begin(), nodes.end(), node.id, [](const NeatNodeGene& node, int id) { return node.id < id; });
+	nodes.insert(position, node);
+}
+
+void NeatGenome::AddConnection(const NeatConnectionGene& connection)
+{
+	auto position = std::lower_bound(connections.begin(), connections.end(), connection.innovation,
+		[](const NeatConnectionGene& connection, int innovation) { return connection.innovation < innovation; });
+	connections.insert(position, connection);
+}
+
+NeatNetwork::NeatNetwork(const NeatGenome& genome)
+{
+	//Walk back from the output, anything that can't reach it is never evaluated
+	std::set<int> reachesOutput = { NETWORK_INPUTS };
+	std::vector<int> stack = { NETWORK_INPUTS };
+	while (!stack.empty())
+	{
+		int id = stack.back();
+		stack.pop_back();
+		for (const auto& connection : genome.connections)
+		{
+			if (connection.enabled && connection.to == id && reachesOutput.insert(connection.from).second)
+				stack.push_back(connection.from);
+		}
+	}
+
+	//The inputs keep their ids as slots, the compiled nodes follow in evaluation order
+	std::map<int, uint16_t> slots;
+	initialValues.assign(NETWORK_INPUTS, 0.0f);
+	std::vector<int> order = genome.GetTopologicalOrder();
+	for (int id : order)
+	{
+		if (id < NETWORK_INPUTS)
+			slots[id] = (uint16_t)id;
+		else if (reachesOutput.count(id))
+		{
+			slots[id] = (uint16_t)initialValues.size();
+			auto node = std::find_if(genome.nodes.begin(), genome.nodes.end(), [id](const NeatNodeGene& node) { return node.id == id; });
+			initialValues.push_back(node->bias);
+		}
+	}
+
+	for (int id : order)
+	{
+		if (id < NETWORK_INPUTS || !reachesOutput.count(id))
+			continue;
+		uint16_t target = slots.at(id);
+		for (const auto& connection : genome.connections)
+		{
+			if (connection.enabled && connection.to == id)
+				instructions.push_back({ target, slots.at(connection.from), connection.weight });
+		}
+		//Hidden nodes take the activation like the dense network's, the output only sums
+		if (id != NETWORK_INPUTS)
+			instructions.push_back({ target, activateSource, 0.0f });
+	}
+	outputSlot = slots.count(NETWORK_INPUTS) ? slots.at(NETWORK_INPUTS) : 0;
+	values.resize(initialValues.size());
+}
+
+bool NeatNetwork::ShouldFlap(const float* inputs) const
+{
+	//Same step function as the OutputNode
+	return !(Evaluate(inputs) < 0);
+}
+
+float NeatNetwork::Evaluate(const float* inputs) const
+{
+	std::copy(initialValues.begin(), initialValues.end(), values.begin());
+	std::copy(inputs, inputs + NETWORK_INPUTS, values.begin());
+	for (const Instruction& instruction : instructions)
+	{
+		if (instruction.source == activateSource)
+			values[instruction.target] = Activation::Apply(values[instruction.target]);
+		else
+			values[instruction.target] += instruction.weight * values[instruction.source];
+	}
+	return values[outputSlot];
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "CompiledNetwork.h"
+#include "DEFINITIONS.hpp"
+
+//library for json files, namepspace definition
+#include "nlohmann/json.hpp"
+
+enum NeatNodeTypes
+{
+	eNeatInput,
+	eNeatHidden,
+	eNeatOutput
+};
+
+struct NeatNodeGene
+{
+	int id;
+	int type;
+	float bias;
+};
+
+struct NeatConnectionGene
+{
+	int innovation;
+	int from;
+	int to;
+	float weight;
+	bool enabled;
+};
+
+class NeatGenome;
+
+//Hands out innovation numbers and node ids for one round of mutations. A connection that already exists anywhere in the
+//population keeps its number, and splitting the same connection twice gives the same node, so crossover lines genes up
+class NeatInnovations
+{
+public:
+	//Registers a genome's genes and starts numbering after its highest ids
+	void Continue(const NeatGenome& genome);
+
+	int GetConnectionInnovation(int from, int to);
+	//Id of the node that splits the connection with this innovation
+	int GetSplitNode(int innovation);
+
+private:
+	std::map<std::pair<int, int>, int> connections;
+	std::map<int, int> splitNodes;
+	int nextInnovation = 0;
+	int nextNode = 0;
+};
+
+//NEAT genome. Node ids 0 to NETWORK_INPUTS - 1 are the inputs and NETWORK_INPUTS is the output, hidden nodes come after.
+//Connections only ever go forward, so the network never has loops
+class NeatGenome
+{
+public:
+	//Every input connected straight to the output with random weights. The connections take innovations 0 to NETWORK_INPUTS - 1
+	static NeatGenome CreateMinimal();
+	//Matching genes come from either parent, the rest from the fitter one, so the child keeps the fitter topology
+	static NeatGenome Crossover(const NeatGenome& fitter, const NeatGenome& other);
+	//Compatibility distance the population is split into species by
+	static float Distance(const NeatGenome& first, const NeatGenome& second);
+
+	//Same odds as the dense genetic algorithm, per weight and per bias
+	void MutateWeights(int mutationRate, float mutationAdjustment);
+	void MutateAddConnection(NeatInnovations& innovations);
+	void MutateAddNode(NeatInnovations& innovations);
+	//Removes an enabled connection, and any hidden node it leaves without connections
+	void MutateRemoveConnection();
+
+	int GetEnabledConnectionCount() const;
+	//Same bound as Bird::GetInputSensitivity, the sum over every enabled path of the absolute weights along it
+	void GetInputSensitivity(float* sensitivity) const;
+	//Hash of the genes, with the weights and biases rounded to FITNESS_CACHE_QUANTUM
+	uint64_t GetHash() const;
+
+	//Nodes and Connections arrays, stored under a gene of the epoch file
+	nlohmann::json ToJson() const;
+	bool FromJson(const nlohmann::json& data);
+
+	//Sorted by id
+	std::vector<NeatNodeGene> nodes;
+	//Sorted by innovation
+	std::vector<NeatConnectionGene> connections;
+
+	//Node ids with every node after the ones feeding it. Disabled connections count, so enabling one never breaks the order
+	std::vector<int> GetTopologicalOrder() const;
+
+private:
+	//True if from can already be reached from to
+	bool CreatesCycle(int from, int to) const;
+	const NeatNodeGene* FindNode(int id) const;
+	void AddNode(const NeatNodeGene& node);
+	void AddConnection(const NeatConnectionGene& connection);
+};
+
+//A genome compiled to a flat instruction list over one array of values: the inputs, then every node that can reach the
+//output in topological order. Disabled connections and dead end nodes are dropped, so smaller genomes run fewer instructions
+class NeatNetwork : public CompiledNetwork
+{
+public:
+	NeatNetwork(const NeatGenome& genome);
+
+	bool ShouldFlap(const float* inputs) const override;
+	float Evaluate(const float* inputs) const override;
+
+	int GetInstructionCount() const { return (int)instructions.size(); }
+
+private:
+	//values[target] += weight * values[source], or values[target] = Activation::Apply(values[target]) when source is activateSource
+	struct Instruction
+	{
+		uint16_t target;
+		uint16_t source;
+		float weight;
+	};
+	static const uint16_t activateSource = 0xFFFF;
+
+	std::vector<Instruction> instructions;
+	//Each node's bias, copied in before the instructions run
+	std::vector<float> initialValues;
+	//Scratch space. A network is only ever evaluated by one thread at a time
+	mutable std::vector<float> values;
+	uint16_t outputSlot = 0;
+};
@@ -1,5 +1,6 @@
 #include "Node.h"
 #include "DEFINITIONS.hpp"
+#include "Activation.h"
 void Node::AddInput(float input)
 {
 	sum += input;
@@ -10,12 +11,12 @@ float Node::GenerateOutput()
 	return sum;
 }
 
-InputNode::InputNode(bool p_lastLayer)
+InputNode::InputNode(bool p_lastLayer, int p_nextLayerSize)
 {
 	lastLayer = p_lastLayer;
 	//Generate random weights (not 0)
 	if (!lastLayer) {
-		for (int i = 0; i < NODES_PER_LAYER; i++)
+		for (int i = 0; i < p_nextLayerSize; i++)
 		{
 			float weight = 0;
 			while (std::abs(weight) < 0.0001f) {
@@ -43,12 +44,12 @@ float InputNode::GenerateOutput(int nodeIndex)
 	return sum * weights.at(nodeIndex);
 }
 
-ActivationNode::ActivationNode(bool p_lastLayer)
+ActivationNode::ActivationNode(bool p_lastLayer, int p_nextLayerSize)
 {
 	lastLayer = p_lastLayer;
 	if (!lastLayer) {
 		//Generate random weights and bias
-		for (int i = 0; i < NODES_PER_LAYER; i++)
+		for (int i = 0; i < p_nextLayerSize; i++)
 		{
 			float weight = 0;
 			while (std::abs(weight) < 0.0001f) {
@@ -72,8 +73,8 @@ float ActivationNode::GenerateOutput()
 {
 	//add bias
 	float val = sum + bias;
-	//Apply TanH or ReLU function 
-	val = std::tanh(val);
+	//Apply the run's activation function
+	val = Activation::Apply(val);
 
 	return val * weights.at(0);
 }
@@ -82,8 +83,8 @@ float ActivationNode::GenerateOutput(int nodeIndex)
 {
 	//add bias
 	float val = sum + bias;
-	//Apply TanH or ReLU function 
-	val = std::tanh(val);
+	//Apply the run's activation function
+	val = Activation::Apply(val);
 
 	return val * weights.at(nodeIndex);
 }
@@ -23,7 +23,8 @@ protected:
 class InputNode : public Node
 {
 public:
-	InputNode(bool p_lastLayer);
+	//nextLayerSize is the number of weights generated when this isn't the last layer
+	InputNode(bool p_lastLayer, int p_nextLayerSize);
 
 	InputNode(std::vector<float> p_weights, bool p_lastLayer) { weights = std::vector<float>(p_weights); lastLayer = p_lastLayer; }
 	
@@ -37,7 +38,7 @@ public:
 class ActivationNode : public Node
 {
 public:
-	ActivationNode(bool p_lastLayer);
+	ActivationNode(bool p_lastLayer, int p_nextLayerSize);
 
 	ActivationNode(std::vector<float> p_weights, float p_bias, bool p_lastLayer) : bias(p_bias) { weights = std::vector<float>(p_weights); lastLayer = p_lastLayer; }
 
@@ -0,0 +1,354 @@
+#include "Optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+//Jacobi sweeps allowed before the eigendecomposition settles for what it has
+#define CMA_MAX_JACOBI_SWEEPS 50
+
+namespace
+{
+	//Dense helpers over contiguous arrays. The loops are plain and unit stride, so the compiler vectorises them
+	void Axpy(double a, const double* x, double* y, int length)
+	{
+		for (int i = 0; i < length; i++)
+			y[i] += a * x[i];
+	}
+
+	double Dot(const double* x, const double* y, int length)
+	{
+		double sum = 0.0;
+		for (int i = 0; i < length; i++)
+			sum += x[i] * y[i];
+		return sum;
+	}
+
+	//y = M x for a row major n by n matrix
+	void MultiplyMatrix(const double* matrix, const double* x, double* y, int n)
+	{
+		for (int i = 0; i < n; i++)
+			y[i] = Dot(matrix + i * n, x, n);
+	}
+
+	//y = M^T x
+	void MultiplyTransposed(const double* matrix, const double* x, double* y, int n)
+	{
+		std::fill(y, y + n, 0.0);
+		for (int i = 0; i < n; i++)
+			Axpy(x[i], matrix + i * n, y, n);
+	}
+
+	//Cyclic Jacobi rotations on a symmetric matrix. Leaves the eigenvalues on its diagonal and the eigenvectors in the
+	//columns of vectors. Plenty fast for a few hundred parameters
+	void JacobiEigen(std::vector<double>& matrix, std::vector<double>& vectors, int n)
+	{
+		vectors.assign(n * n, 0.0);
+		for (int i = 0; i < n; i++)
+			vectors[i * n + i] = 1.0;
+
+		for (int sweep = 0; sweep < CMA_MAX_JACOBI_SWEEPS; sweep++)
+		{
+			double offDiagonal = 0.0;
+			for (int p = 0; p < n; p++)
+				for (int q = p + 1; q < n; q++)
+					offDiagonal += matrix[p * n + q] * matrix[p * n + q];
+			if (offDiagonal < 1e-22)
+				return;
+
+			for (int p = 0; p < n; p++)
+			{
+				for (int q = p + 1; q < n; q++)
+				{
+					double apq = matrix[p * n + q];
+					if (std::abs(apq) < 1e-300)
+						continue;
+					double theta = (matrix[q * n + q] - matrix[p * n + p]) / (2.0 * apq);
+					double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+					double c = 1.0 / std::sqrt(t * t + 1.0);
+					double s = t * c;
+
+					for (int k = 0; k < n; k++)
+					{
+						double akp = matrix[k * n + p];
+						double akq = matrix[k * n + q];
+						matrix[k * n + p] = c * akp - s * akq;
+						matrix[k * n + q] = s * akp + c * akq;
+					}
+					for (int k = 0; k < n; k++)
+					{
+						double apk = matrix[p * n + k];
+						double aqk = matrix[q * n + k];
+						matrix[p * n + k] = c * apk - s * aqk;
+						matrix[q * n + k] = s * apk + c * aqk;
+					}
+					for (int k = 0; k < n; k++)
+					{
+						double vkp = vectors[k * n + p];
+						double vkq = vectors[k * n + q];
+						vectors[k * n + p] = c * vkp - s * vkq;
+						vectors[k * n + q] = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<float> ToFloats(const std::vector<double>& values)
+	{
+		return std::vector<float>(values.begin(), values.end());
+	}
+}
+
+void Optimizer::Start(const std::vector<float>& startMean)
+{
+	mean.assign(startMean.begin(), startMean.end());
+}
+
+nlohmann::json Optimizer::ToJson() const
+{
+	nlohmann::json data;
+	data["Type"] = GetType();
+	data["Sigma"] = sigma;
+	data["Mean"] = mean;
+	return data;
+}
+
+bool Optimizer::FromJson(const nlohmann::json& data, int dimension)
+{
+	if (data.value("Type", "") != GetType() || !data.contains("Mean") || data["Mean"].size() != (size_t)dimension)
+		return false;
+	mean = data["Mean"].get<std::vector<double>>();
+	sigma = data.value("Sigma", sigma);
+	return true;
+}
+
+Optimizer* Optimizer::Create(const std::string& name, float sigma, float learningRate, unsigned int seed)
+{
+	if (name == "ES")
+		return new EvolutionStrategy(sigma, learningRate, seed);
+	if (name == "CMA-ES")
+		return new CmaEvolutionStrategy(sigma, seed);
+	return nullptr;
+}
+
+std::vector<double> Optimizer::SampleNormal(int length)
+{
+	std::vector<double> sample(length);
+	for (auto& value : sample)
+		value = normal(random);
+	return sample;
+}
+
+std::vector<std::vector<float>> EvolutionStrategy::Ask(int count)
+{
+	int n = GetDimension();
+	std::vector<std::vector<float>> candidates;
+	noise.clear();
+
+	//Antithetic sampling, every noise vector is flown both ways so the mean's own fitness cancels out of the gradient
+	for (int pair = 0; pair < count / 2; pair++)
+	{
+		noise.push_back(SampleNormal(n));
+		std::vector<double> plus = mean;
+		std::vector<double> minus = mean;
+		Axpy(sigma, noise.back().data(), plus.data(), n);
+		Axpy(-sigma, noise.back().data(), minus.data(), n);
+		candidates.push_back(ToFloats(plus));
+		candidates.push_back(ToFloats(minus));
+	}
+	//An odd population also flies the mean itself
+	if (count % 2 == 1)
+		candidates.push_back(ToFloats(mean));
+	return candidates;
+}
+
+void EvolutionStrategy::Tell(const std::vector<double>& fitness)
+{
+	int sampleCount = (int)noise.size() * 2;
+	if (sampleCount < 2 || fitness.size() < (size_t)sampleCount)
+		return;
+
+	//Centred ranks in [-0.5, 0.5]. Scores are whole pipes and mostly tied early on, the ranks keep the update sane
+	std::vector<int> order(sampleCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&fitness](int first, int second) { return fitness[first] < fitness[second]; });
+	std::vector<double> utility(sampleCount);
+	for (int first = 0; first < sampleCount;)
+	{
+		//Tied samples share their mean rank, so a tie never pushes the mean either way
+		int last = first;
+		while (last + 1 < sampleCount && fitness[order[last + 1]] == fitness[order[first]])
+			last++;
+		double rank = 0.5 * (first + last);
+		for (int i = first; i <= last; i++)
+			utility[order[i]] = rank / (sampleCount - 1) - 0.5;
+		first = last + 1;
+	}
+
+	int n = GetDimension();
+	std::vector<double> gradient(n, 0.0);
+	for (int pair = 0; pair < sampleCount / 2; pair++)
+		Axpy(utility[pair * 2] - utility[pair * 2 + 1], noise[pair].data(), gradient.data(), n);
+	Axpy(learningRate / (sampleCount * sigma), gradient.data(), mean.data(), n);
+	noise.clear();
+}
+
+void CmaEvolutionStrategy::Start(const std::vector<float>& startMean)
+{
+	Optimizer::Start(startMean);
+	int n = GetDimension();
+	covariance.assign(n * n, 0.0);
+	for (int i = 0; i < n; i++)
+		covariance[i * n + i] = 1.0;
+	covariancePath.assign(n, 0.0);
+	sigmaPath.assign(n, 0.0);
+	generation = 0;
+	eigenvectors.clear();
+}
+
+std::vector<std::vector<float>> CmaEvolutionStrategy::Ask(int count)
+{
+	int n = GetDimension();
+	if (eigenvectors.size() != (size_t)(n * n))
+		UpdateEigensystem();
+
+	std::vector<std::vector<float>> candidates;
+	steps.clear();
+	std::vector<double> scaled(n);
+	for (int i = 0; i < count; i++)
+	{
+		//y = B D z, so y is drawn from N(0, C)
+		std::vector<double> z = SampleNormal(n);
+		for (int j = 0; j < n; j++)
+			scaled[j] = eigenvalueRoots[j] * z[j];
+		std::vector<double> step(n);
+		MultiplyMatrix(eigenvectors.data(), scaled.data(), step.data(), n);
+
+		std::vector<double> candidate = mean;
+		Axpy(sigma, step.data(), candidate.data(), n);
+		candidates.push_back(ToFloats(candidate));
+		steps.push_back(step);
+	}
+	return candidates;
+}
+
+void CmaEvolutionStrategy::Tell(const std::vector<double>& fitness)
+{
+	int lambda = (int)steps.size();
+	int n = GetDimension();
+	if (lambda < 2 || fitness.size() < (size_t)lambda)
+		return;
+
+	//Log weights over the better half
+	int mu = lambda / 2;
+	std::vector<double> weights(mu);
+	for (int i = 0; i < mu; i++)
+		weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+	double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+	for (auto& weight : weights)
+		weight /= weightSum;
+	double muEffective = 1.0 / Dot(weights.data(), weights.data(), mu);
+
+	double cc = (4.0 + muEffective / n) / (n + 4.0 + 2.0 * muEffective / n);
+	double cs = (muEffective + 2.0) / (n + muEffective + 5.0);
+	double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEffective);
+	double cmu = std::min(1.0 - c1, 2.0 * (muEffective - 2.0 + 1.0 / muEffective) / ((n + 2.0) * (n + 2.0) + muEffective));
+	double damping = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEffective - 1.0) / (n + 1.0)) - 1.0) + cs;
+	double expectedNorm = std::sqrt((double)n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+	std::vector<int> order(lambda);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&fitness](int first, int second) { return fitness[first] > fitness[second]; });
+
+	//Weighted mean step of the better half
+	std::vector<double> meanStep(n, 0.0);
+	for (int i = 0; i < mu; i++)
+		Axpy(weights[i], steps[order[i]].data(), meanStep.data(), n);
+	Axpy(sigma, meanStep.data(), mean.data(), n);
+
+	//C^-1/2 * meanStep = B D^-1 B^T meanStep
+	std::vector<double> rotated(n), whitened(n);
+	MultiplyTransposed(eigenvectors.data(), meanStep.data(), rotated.data(), n);
+	for (int j = 0; j < n; j++)
+		rotated[j] /= eigenvalueRoots[j];
+	MultiplyMatrix(eigenvectors.data(), rotated.data(), whitened.data(), n);
+
+	for (int j = 0; j < n; j++)
+		sigmaPath[j] *= 1.0 - cs;
+	Axpy(std::sqrt(cs * (2.0 - cs) * muEffective), whitened.data(), sigmaPath.data(), n);
+	double sigmaPathNorm = std::sqrt(Dot(sigmaPath.data(), sigmaPath.data(), n));
+
+	//Stalls the covariance path while the step size is still growing quickly
+	bool pathUpdate = sigmaPathNorm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (generation + 1))) / expectedNorm < 1.4 + 2.0 / (n + 1.0);
+	for (int j = 0; j < n; j++)
+		covariancePath[j] *= 1.0 - cc;
+	if (pathUpdate)
+		Axpy(std::sqrt(cc * (2.0 - cc) * muEffective), meanStep.data(), covariancePath.data(), n);
+
+	//Rank one update from the path, rank mu update from the selected steps
+	double keep = 1.0 - c1 - cmu + (pathUpdate ? 0.0 : c1 * cc * (2.0 - cc));
+	for (int i = 0; i < n; i++)
+	{
+		double* row = &covariance[i * n];
+		for (int j = 0; j < n; j++)
+			row[j] *= keep;
+		Axpy(c1 * covariancePath[i], covariancePath.data(), row, n);
+		for (int k = 0; k < mu; k++)
+		{
+			const std::vector<double>& step = steps[order[k]];
+			Axpy(cmu * weights[k] * step[i], step.data(), row, n);
+		}
+	}
+
+	sigma *= std::exp((cs / damping) * (sigmaPathNorm / expectedNorm - 1.0));
+	generation++;
+	steps.clear();
+	UpdateEigensystem();
+}
+
+nlohmann::json CmaEvolutionStrategy::ToJson() const
+{
+	nlohmann::json data = Optimizer::ToJson();
+	data["Covariance"] = covariance;
+	data["CovariancePath"] = covariancePath;
+	data["SigmaPath"] = sigmaPath;
+	data["Generation"] = generation;
+	return data;
+}
+
+bool CmaEvolutionStrategy::FromJson(const nlohmann::json& data, int dimension)
+{
+	if (!Optimizer::FromJson(data, dimension))
+		return false;
+	try
+	{
+		covariance = data.at("Covariance").get<std::vector<double>>();
+		covariancePath = data.at("CovariancePath").get<std::vector<double>>();
+		sigmaPath = data.at("SigmaPath").get<std::vector<double>>();
+		generation = data.at("Generation").get<int>();
+	}
+	catch (const nlohmann::json::exception&)
+	{
+		return false;
+	}
+	size_t length = (size_t)dimension;
+	if (covariance.size() != length * length || covariancePath.size() != length || sigmaPath.size() != length)
+		return false;
+	UpdateEigensystem();
+	return true;
+}
+
+void CmaEvolutionStrategy::UpdateEigensystem()
+{
+	int n = GetDimension();
+	//Keep C exactly symmetric, rounding would otherwise drift it apart
+	for (int i = 0; i < n; i++)
+		for (int j = i + 1; j < n; j++)
+			covariance[j * n + i] = covariance[i * n + j] = 0.5 * (covariance[i * n + j] + covariance[j * n + i]);
+
+	std::vector<double> diagonal = covariance;
+	JacobiEigen(diagonal, eigenvectors, n);
+	eigenvalueRoots.resize(n);
+	for (int i = 0; i < n; i++)
+		eigenvalueRoots[i] = std::sqrt(std::max(diagonal[i * n + i], 1e-20));
+}
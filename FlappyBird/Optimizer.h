@@ -0,0 +1,95 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+
+//library for json files, namepspace definition
+#include "nlohmann/json.hpp"
+
+//Gradient free search over the flat parameter vector of the fixed topology, laid out like PopulationFile::PackNetworks.
+//Each generation Ask hands out the candidates, the birds fly them, and Tell takes their fitness back in the same order.
+//The genetic algorithm in GameState::Evolve works on the birds directly and isn't one of these
+class Optimizer
+{
+public:
+	Optimizer(float p_sigma, unsigned int seed) : sigma(p_sigma), random(seed) { }
+	virtual ~Optimizer() { }
+
+	//Centres the search on this parameter vector and forgets everything learned so far
+	virtual void Start(const std::vector<float>& startMean);
+	virtual std::vector<std::vector<float>> Ask(int count) = 0;
+	//Higher is better, only the order of the values is used
+	virtual void Tell(const std::vector<double>& fitness) = 0;
+
+	int GetDimension() const { return (int)mean.size(); }
+	double GetSigma() const { return sigma; }
+
+	//The search state, so a run continues where it stopped. FromJson fails if the type or dimension doesn't match
+	virtual nlohmann::json ToJson() const;
+	virtual bool FromJson(const nlohmann::json& data, int dimension);
+
+	//"ES" or "CMA-ES", nullptr for anything else
+	static Optimizer* Create(const std::string& name, float sigma, float learningRate, unsigned int seed);
+
+protected:
+	virtual const char* GetType() const = 0;
+	//A vector of standard normal samples
+	std::vector<double> SampleNormal(int length);
+
+	std::vector<double> mean;
+	double sigma;
+	std::mt19937 random;
+	std::normal_distribution<double> normal;
+};
+
+//OpenAI style evolution strategy. Candidates are mirrored pairs around the mean, and the mean follows the gradient
+//estimated from their centred fitness ranks, so the step size doesn't depend on the score scale
+class EvolutionStrategy : public Optimizer
+{
+public:
+	EvolutionStrategy(float p_sigma, float p_learningRate, unsigned int seed) : Optimizer(p_sigma, seed), learningRate(p_learningRate) { }
+
+	std::vector<std::vector<float>> Ask(int count) override;
+	void Tell(const std::vector<double>& fitness) override;
+
+protected:
+	const char* GetType() const override { return "ES"; }
+
+private:
+	double learningRate;
+	//One noise vector per mirrored pair of the last Ask
+	std::vector<std::vector<double>> noise;
+};
+
+//Covariance matrix adaptation. Learns a full covariance and step size for the sampling distribution from the
+//better half of every generation, following Hansen's tutorial with the default weights and learning rates
+class CmaEvolutionStrategy : public Optimizer
+{
+public:
+	CmaEvolutionStrategy(float p_sigma, unsigned int seed) : Optimizer(p_sigma, seed) { }
+
+	void Start(const std::vector<float>& startMean) override;
+	std::vector<std::vector<float>> Ask(int count) override;
+	void Tell(const std::vector<double>& fitness) override;
+
+	nlohmann::json ToJson() const override;
+	bool FromJson(const nlohmann::json& data, int dimension) override;
+
+protected:
+	const char* GetType() const override { return "CMA-ES"; }
+
+private:
+	//Eigendecomposition of the covariance, so C = B diag(D^2) B^T
+	void UpdateEigensystem();
+
+	//Row major n by n
+	std::vector<double> covariance;
+	std::vector<double> eigenvectors;
+	std::vector<double> eigenvalueRoots;
+	//Evolution paths of the covariance and of the step size
+	std::vector<double> covariancePath;
+	std::vector<double> sigmaPath;
+	int generation = 0;
+	//Steps of the last Ask's candidates from the mean, before scaling by sigma
+	std::vector<std::vector<double>> steps;
+};
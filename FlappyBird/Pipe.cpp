@@ -18,6 +18,7 @@ namespace Sonar
 		sprite.setPosition((float)this->_data->window.getSize().x, (float)this->_data->window.getSize().y - sprite.getLocalBounds().height - _pipeSpawnYOffset);
 
 		pipeSprites.push_back(sprite);
+		_layoutVersion++;
 	}
 
 	void Pipe::SpawnTopPipe()
@@ -27,6 +28,7 @@ namespace Sonar
 		sprite.setPosition((float)this->_data->window.getSize().x, (float)-_pipeSpawnYOffset);
 
 		pipeSprites.push_back(sprite);
+		_layoutVersion++;
 	}
 
 	void Pipe::SpawnInvisiblePipe()
@@ -37,6 +39,7 @@ namespace Sonar
 		sprite.setColor(sf::Color(0, 0, 0, 0));
 
 		pipeSprites.push_back(sprite);
+		_layoutVersion++;
 	}
 
 	void Pipe::SpawnScoringPipe()
@@ -56,6 +59,7 @@ namespace Sonar
 			if (pipeSprites.at(i).getPosition().x < 0 - pipeSprites.at(i).getLocalBounds().width)
 			{
 				pipeSprites.erase( pipeSprites.begin( ) + i );
+				_layoutVersion++;
 			}
 			else
 			{
@@ -71,6 +75,7 @@ namespace Sonar
 			if (scoringPipes.at(i).getPosition().x < 0 - scoringPipes.at(i).getLocalBounds().width)
 			{
 				scoringPipes.erase(scoringPipes.begin() + i);
+				_columnsRemoved++;
 			}
 			else
 			{
@@ -92,7 +97,12 @@ namespace Sonar
 
 	void Pipe::RandomisePipeOffset()
 	{
-		_pipeSpawnYOffset = rand() % (_landHeight + 1);
+		_pipeSpawnYOffset = _courseRandom() % (_landHeight + 1);
+	}
+
+	void Pipe::SetCourseSeed(unsigned int seed)
+	{
+		_courseRandom.seed(seed);
 	}
 
 	const std::vector<sf::Sprite> &Pipe::GetSprites() const
@@ -100,8 +110,19 @@ namespace Sonar
 		return pipeSprites;
 	}
 
-	std::vector<sf::Sprite> &Pipe::GetScoringSprites()
+	const std::vector<sf::Sprite> &Pipe::GetScoringSprites() const
 	{
 		return scoringPipes;
 	}
+
+	int Pipe::CountColumnsPassed(float x) const
+	{
+		//Scoring pipes are kept in spawn order, so the passed ones are at the front
+		int columns = _columnsRemoved;
+		for (unsigned int i = 0; i < scoringPipes.size() && scoringPipes.at(i).getGlobalBounds().left <= x; i++)
+		{
+			columns++;
+		}
+		return columns;
+	}
 }
\ No newline at end of file
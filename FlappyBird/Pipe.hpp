@@ -2,6 +2,7 @@
 
 #include <SFML/Graphics.hpp>
 #include "Game.hpp"
+#include <random>
 #include <vector>
 
 namespace Sonar
@@ -18,9 +19,16 @@ namespace Sonar
 		void MovePipes(float dt);
 		void DrawPipes();
 		void RandomisePipeOffset();
+		//Restarts the course. The same seed spawns the same gaps in the same order
+		void SetCourseSeed(unsigned int seed);
 
 		const std::vector<sf::Sprite> &GetSprites() const;
-		std::vector<sf::Sprite> &GetScoringSprites();
+		//Goes up whenever a pipe is spawned or removed
+		int GetLayoutVersion() const { return _layoutVersion; }
+		const std::vector<sf::Sprite> &GetScoringSprites() const;
+		//Columns whose scoring pipe has reached x so far, including the ones already scrolled off screen.
+		//Only goes up while the pipes move left
+		int CountColumnsPassed(float x) const;
 
 	private:
 		GameDataRef _data;
@@ -29,6 +37,10 @@ namespace Sonar
 
 		int _landHeight;
 		int _pipeSpawnYOffset;
+		int _layoutVersion = 0;
+		int _columnsRemoved = 0;
+		//The course has its own generator, so the gaps don't depend on how much the genetic algorithm drew from rand()
+		std::mt19937 _courseRandom;
 
 	};
 }
\ No newline at end of file
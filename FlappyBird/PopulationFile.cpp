@@ -0,0 +1,190 @@
+#include "PopulationFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#define POPULATION_FILE_VERSION 1
+
+namespace
+{
+	const char populationMagic[4] = { 'F', 'B', 'P', 'F' };
+	const char resultsMagic[4] = { 'F', 'B', 'R', 'F' };
+
+	//Weights of a node, padded or cut to the count the network reads
+	void AppendWeights(const std::vector<float>& weights, int count, std::vector<float>& parameters)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			parameters.push_back(i < (int)weights.size() ? weights.at(i) : 0.0f);
+		}
+	}
+}
+
+namespace Sonar
+{
+	bool PopulationFile::Write(const std::string& fileName, const std::vector<Bird*>& birds, unsigned int courseSeed, int generation)
+	{
+		std::vector<uint32_t> layerSizes;
+		std::vector<float> parameters;
+		if (!PackNetworks(birds, layerSizes, parameters))
+		{
+			std::cout << "Error Writing Population " << fileName << ": mismatched topologies" << std::endl;
+			return false;
+		}
+
+		Header header;
+		std::memcpy(header.magic, populationMagic, sizeof(header.magic));
+		header.version = POPULATION_FILE_VERSION;
+		header.genomeCount = (uint32_t)birds.size();
+		header.parameterCount = (uint32_t)(parameters.size() / birds.size());
+		header.courseSeed = courseSeed;
+		header.generation = generation;
+		header.layerCount = (uint32_t)layerSizes.size();
+
+		std::ofstream outputFile(fileName, std::ios::binary | std::ios::trunc);
+		if (!outputFile.good())
+		{
+			std::cout << "Error Writing Population " << fileName << std::endl;
+			return false;
+		}
+		outputFile.write((const char*)&header, sizeof(header));
+		outputFile.write((const char*)layerSizes.data(), layerSizes.size() * sizeof(uint32_t));
+		outputFile.write((const char*)parameters.data(), parameters.size() * sizeof(float));
+		return outputFile.good();
+	}
+
+	bool PopulationFile::PackNetworks(const std::vector<Bird*>& birds, std::vector<uint32_t>& layerSizes, std::vector<float>& parameters)
+	{
+		layerSizes.clear();
+		parameters.clear();
+		//NEAT genomes have no layers to lay out
+		if (birds.empty() || birds.at(0)->genome != nullptr)
+			return false;
+
+		for (const auto& layer : birds.at(0)->nodeNetwork)
+		{
+			layerSizes.push_back((uint32_t)layer.size());
+		}
+		int layerCount = (int)layerSizes.size();
+
+		for (Bird* bird : birds)
+		{
+			const std::vector<std::vector<Node*>>& nodeNetwork = bird->nodeNetwork;
+			if (nodeNetwork.size() != layerSizes.size())
+				return false;
+			for (int i = 0; i < layerCount; i++)
+			{
+				if (nodeNetwork.at(i).size() != layerSizes.at(i))
+					return false;
+				int weightCount = i + 1 < layerCount ? (int)layerSizes.at(i + 1) : 1;
+				for (int j = 0; j < (int)nodeNetwork.at(i).size(); j++)
+				{
+					if (i == 0)
+						AppendWeights(static_cast<InputNode*>(nodeNetwork.at(i).at(j))->weights, weightCount, parameters);
+					else
+					{
+						ActivationNode* node = static_cast<ActivationNode*>(nodeNetwork.at(i).at(j));
+						AppendWeights(node->weights, weightCount, parameters);
+						parameters.push_back(node->bias);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	bool PopulationFile::Open(const std::string& fileName)
+	{
+		_header = nullptr;
+		if (!_file.Open(fileName, false) || _file.GetSize() < sizeof(Header))
+		{
+			std::cout << "Error Loading Population " << fileName << std::endl;
+			return false;
+		}
+
+		const Header* header = (const Header*)_file.GetData();
+		size_t expectedSize = sizeof(Header) + header->layerCount * sizeof(uint32_t) + (size_t)header->genomeCount * header->parameterCount * sizeof(float);
+		if (std::memcmp(header->magic, populationMagic, sizeof(header->magic)) != 0 || header->version != POPULATION_FILE_VERSION
+			|| header->layerCount == 0 || _file.GetSize() != expectedSize)
+		{
+			std::cout << "Error Reading Population " << fileName << std::endl;
+			_file.Close();
+			return false;
+		}
+
+		_header = header;
+		_layerSizes = (const uint32_t*)(_file.GetData() + sizeof(Header));
+		_parameters = (const float*)(_layerSizes + header->layerCount);
+		return true;
+	}
+
+	std::vector<std::vector<Node*>> PopulationFile::CreateNetwork(int index) const
+	{
+		return BuildNetwork(_layerSizes, (int)_header->layerCount, _parameters + (size_t)index * _header->parameterCount);
+	}
+
+	std::vector<std::vector<Node*>> PopulationFile::BuildNetwork(const uint32_t* layerSizes, int layerCount, const float* parameters)
+	{
+		const float* parameter = parameters;
+		std::vector<std::vector<Node*>> nodeNetwork;
+		for (int i = 0; i < layerCount; i++)
+		{
+			bool lastLayer = i + 1 == layerCount;
+			int weightCount = lastLayer ? 1 : (int)layerSizes[i + 1];
+			std::vector<Node*> layer;
+			for (unsigned int j = 0; j < layerSizes[i]; j++)
+			{
+				std::vector<float> weights(parameter, parameter + weightCount);
+				parameter += weightCount;
+				if (i == 0)
+					layer.push_back(new InputNode(weights, lastLayer));
+				else
+					layer.push_back(new ActivationNode(weights, *parameter++, lastLayer));
+			}
+			nodeNetwork.push_back(layer);
+		}
+		return nodeNetwork;
+	}
+
+	bool ResultsFile::Create(const std::string& fileName, int genomeCount)
+	{
+		std::ofstream outputFile(fileName, std::ios::binary | std::ios::trunc);
+		if (!outputFile.good())
+		{
+			std::cout << "Error Writing Results " << fileName << std::endl;
+			return false;
+		}
+		int32_t count = genomeCount;
+		std::vector<int32_t> scores(genomeCount, -1);
+		outputFile.write(resultsMagic, sizeof(resultsMagic));
+		outputFile.write((const char*)&count, sizeof(count));
+		outputFile.write((const char*)scores.data(), scores.size() * sizeof(int32_t));
+		return outputFile.good();
+	}
+
+	bool ResultsFile::Open(const std::string& fileName)
+	{
+		_scores = nullptr;
+		_genomeCount = 0;
+		size_t headerSize = sizeof(resultsMagic) + sizeof(int32_t);
+		if (!_file.Open(fileName, true) || _file.GetSize() < headerSize)
+		{
+			std::cout << "Error Loading Results " << fileName << std::endl;
+			return false;
+		}
+
+		int32_t count = *(const int32_t*)(_file.GetData() + sizeof(resultsMagic));
+		if (std::memcmp(_file.GetData(), resultsMagic, sizeof(resultsMagic)) != 0 || count < 0
+			|| _file.GetSize() != headerSize + count * sizeof(int32_t))
+		{
+			std::cout << "Error Reading Results " << fileName << std::endl;
+			_file.Close();
+			return false;
+		}
+
+		_genomeCount = count;
+		_scores = (int32_t*)(_file.GetData() + headerSize);
+		return true;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bird.hpp"
+#include "MappedFile.hpp"
+
+namespace Sonar
+{
+	//Binary population for evaluation workers. A header, the node count of each layer, then every genome's weights
+	//and biases as floats, one genome after another. Workers map it read-only, so the genomes are never copied
+	class PopulationFile
+	{
+	public:
+		//Each node keeps the weights the network actually reads, one per node of the next layer or one in the last layer
+		static bool Write(const std::string& fileName, const std::vector<Bird*>& birds, unsigned int courseSeed, int generation);
+
+		bool Open(const std::string& fileName);
+
+		int GetGenomeCount() const { return _header != nullptr ? (int)_header->genomeCount : 0; }
+		unsigned int GetCourseSeed() const { return _header != nullptr ? _header->courseSeed : 0; }
+		int GetGeneration() const { return _header != nullptr ? _header->generation : 0; }
+
+		//Builds a genome back into a node network, owned by the caller
+		std::vector<std::vector<Node*>> CreateNetwork(int index) const;
+
+		//The genome layout on its own, shared with the network protocol. Returns false if the topologies don't match
+		static bool PackNetworks(const std::vector<Bird*>& birds, std::vector<uint32_t>& layerSizes, std::vector<float>& parameters);
+		static std::vector<std::vector<Node*>> BuildNetwork(const uint32_t* layerSizes, int layerCount, const float* parameters);
+
+	private:
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint32_t genomeCount;
+			uint32_t parameterCount;
+			uint32_t courseSeed;
+			int32_t generation;
+			uint32_t layerCount;
+		};
+
+		MappedFile _file;
+		const Header* _header = nullptr;
+		const uint32_t* _layerSizes = nullptr;
+		const float* _parameters = nullptr;
+	};
+
+	//Scores the workers write back, one per genome of the population file. -1 until a worker fills it in
+	class ResultsFile
+	{
+	public:
+		static bool Create(const std::string& fileName, int genomeCount);
+
+		//Mapped writable, every worker writes its own genomes' entries
+		bool Open(const std::string& fileName);
+
+		int GetGenomeCount() const { return _genomeCount; }
+		int GetScore(int index) const { return _scores[index]; }
+		void SetScore(int index, int score) { _scores[index] = score; }
+
+	private:
+		MappedFile _file;
+		int32_t* _scores = nullptr;
+		int _genomeCount = 0;
+	};
+}
@@ -0,0 +1,126 @@
+#include "Process.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+#ifdef _WIN32
+#include <direct.h>
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+namespace
+{
+	std::atomic<long long> allocationCount{ 0 };
+}
+
+//Counting replacement of the global allocator. The array and nothrow forms call through to these
+void* operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* memory = std::malloc(size == 0 ? 1 : size);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+namespace Sonar
+{
+	namespace
+	{
+		std::string Quote(const std::string& argument)
+		{
+			return "\"" + argument + "\"";
+		}
+	}
+
+	int RunProcess(const std::string& executable, const std::vector<std::string>& arguments)
+	{
+		std::string command = Quote(executable);
+		for (const std::string& argument : arguments)
+		{
+			command += " " + Quote(argument);
+		}
+#ifdef _WIN32
+		//cmd strips the outer quotes, keep the quoted executable intact
+		command = "\"" + command + "\"";
+		return std::system(command.c_str());
+#else
+		int status = std::system(command.c_str());
+		if (status == -1 || !WIFEXITED(status))
+			return -1;
+		return WEXITSTATUS(status);
+#endif
+	}
+
+	bool CreateDirectories(const std::string& path)
+	{
+		for (unsigned int i = 1; i <= path.size(); i++)
+		{
+			if (i < path.size() && path.at(i) != '/' && path.at(i) != '\\')
+				continue;
+
+			std::string directory = path.substr(0, i);
+#ifdef _WIN32
+			int result = _mkdir(directory.c_str());
+#else
+			int result = mkdir(directory.c_str(), 0755);
+#endif
+			if (result != 0 && errno != EEXIST)
+				return false;
+		}
+		return true;
+	}
+
+	bool FileExists(const std::string& fileName)
+	{
+		std::ifstream file(fileName);
+		return file.good();
+	}
+
+	bool RemoveFile(const std::string& fileName)
+	{
+		return std::remove(fileName.c_str()) == 0;
+	}
+
+	long long GetPeakMemoryUsage()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+		return (long long)counters.PeakWorkingSetSize;
+#else
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+		//Kilobytes on Linux
+		return (long long)usage.ru_maxrss * 1024;
+#endif
+	}
+
+	long long GetAllocationCount()
+	{
+		return allocationCount.load(std::memory_order_relaxed);
+	}
+}
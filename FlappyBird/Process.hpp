@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Sonar
+{
+	//Runs the executable with the given arguments and blocks until it exits. Returns the exit code
+	int RunProcess(const std::string& executable, const std::vector<std::string>& arguments);
+
+	//Creates the directory and any missing parents. Succeeds if it already exists
+	bool CreateDirectories(const std::string& path);
+
+	bool FileExists(const std::string& fileName);
+	bool RemoveFile(const std::string& fileName);
+
+	//Peak resident memory of this process in bytes, 0 if the platform can't report it
+	long long GetPeakMemoryUsage();
+	//Calls to the global operator new since the process started
+	long long GetAllocationCount();
+}
@@ -0,0 +1,214 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+//Events kept per thread for the trace. Timings past this still reach the histograms
+#define PROFILER_EVENT_CAPACITY 65536
+//Power of two nanosecond buckets, enough for ~18 seconds
+#define PROFILER_HISTOGRAM_BUCKETS 35
+
+namespace Sonar
+{
+	namespace
+	{
+		struct ProfileEvent
+		{
+			const char* name;
+			long long start;
+			long long duration;
+		};
+
+		struct PhaseStats
+		{
+			long long count = 0;
+			long long total = 0;
+			long long min = -1;
+			long long max = 0;
+			long long buckets[PROFILER_HISTOGRAM_BUCKETS] = {};
+		};
+
+		//Only the owning thread writes to a buffer
+		struct ThreadBuffer
+		{
+			int threadId = 0;
+			std::vector<ProfileEvent> events;
+			std::atomic<unsigned int> eventCount{ 0 };
+			std::unordered_map<const char*, PhaseStats> phases;
+			std::unordered_map<const char*, long long> counters;
+		};
+
+		std::atomic<bool> enabled{ false };
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		//Registration is the only locked step, it happens once per thread
+		std::mutex registryMutex;
+		std::vector<ThreadBuffer*> registry;
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			thread_local ThreadBuffer* buffer = nullptr;
+			if (buffer == nullptr)
+			{
+				buffer = new ThreadBuffer();
+				buffer->events.resize(PROFILER_EVENT_CAPACITY);
+				std::lock_guard<std::mutex> lock(registryMutex);
+				buffer->threadId = (int)registry.size();
+				registry.push_back(buffer);
+			}
+			return *buffer;
+		}
+
+		int GetBucket(long long duration)
+		{
+			int bucket = 0;
+			while (duration > 1 && bucket < PROFILER_HISTOGRAM_BUCKETS - 1)
+			{
+				duration >>= 1;
+				bucket++;
+			}
+			return bucket;
+		}
+
+		//Upper bound of the bucket holding the given percentile
+		long long GetPercentile(const PhaseStats& stats, double percentile)
+		{
+			long long target = (long long)(stats.count * percentile);
+			long long seen = 0;
+			for (int i = 0; i < PROFILER_HISTOGRAM_BUCKETS; i++)
+			{
+				seen += stats.buckets[i];
+				if (seen > target)
+					return std::min(2LL << i, stats.max);
+			}
+			return stats.max;
+		}
+	}
+
+	void Profiler::SetEnabled(bool p_enabled)
+	{
+		enabled = p_enabled;
+	}
+
+	bool Profiler::IsEnabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	long long Profiler::Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	void Profiler::Record(const char* name, long long start, long long duration)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		unsigned int index = buffer.eventCount.load(std::memory_order_relaxed);
+		if (index < PROFILER_EVENT_CAPACITY)
+		{
+			ProfileEvent& event = buffer.events[index];
+			event.name = name;
+			event.start = start;
+			event.duration = duration;
+			buffer.eventCount.store(index + 1, std::memory_order_release);
+		}
+
+		PhaseStats& stats = buffer.phases[name];
+		stats.count++;
+		stats.total += duration;
+		if (stats.min < 0 || duration < stats.min)
+			stats.min = duration;
+		if (duration > stats.max)
+			stats.max = duration;
+		stats.buckets[GetBucket(duration)]++;
+	}
+
+	void Profiler::Count(const char* name, long long amount)
+	{
+		GetThreadBuffer().counters[name] += amount;
+	}
+
+	void Profiler::Dump(const std::string& traceFileName, std::ostream& summary)
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		//Merge per name. std::map keeps the table in a stable order
+		std::map<std::string, PhaseStats> phases;
+		std::map<std::string, long long> counters;
+
+		std::ofstream traceFile(traceFileName);
+		traceFile << "{\"traceEvents\":[";
+		bool first = true;
+		for (ThreadBuffer* buffer : registry)
+		{
+			unsigned int eventCount = buffer->eventCount.load(std::memory_order_acquire);
+			for (unsigned int i = 0; i < eventCount; i++)
+			{
+				const ProfileEvent& event = buffer->events[i];
+				//Chrome traces are in microseconds
+				traceFile << (first ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadId
+					<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+				first = false;
+			}
+
+			for (const auto& phase : buffer->phases)
+			{
+				PhaseStats& merged = phases[phase.first];
+				merged.count += phase.second.count;
+				merged.total += phase.second.total;
+				if (merged.min < 0 || (phase.second.min >= 0 && phase.second.min < merged.min))
+					merged.min = phase.second.min;
+				merged.max = std::max(merged.max, phase.second.max);
+				for (int i = 0; i < PROFILER_HISTOGRAM_BUCKETS; i++)
+					merged.buckets[i] += phase.second.buckets[i];
+			}
+			for (const auto& counter : buffer->counters)
+			{
+				counters[counter.first] += counter.second;
+			}
+
+			buffer->eventCount.store(0, std::memory_order_release);
+			buffer->phases.clear();
+			buffer->counters.clear();
+		}
+		long long now = Now();
+		for (const auto& counter : counters)
+		{
+			traceFile << (first ? "" : ",") << "\n{\"name\":\"" << counter.first << "\",\"ph\":\"C\",\"pid\":0,\"ts\":" << now / 1000.0
+				<< ",\"args\":{\"value\":" << counter.second << "}}";
+			first = false;
+		}
+		traceFile << "\n]}" << std::endl;
+
+		//Formatted on its own stream so the caller's stream keeps its flags and precision
+		std::ostringstream table;
+		table << std::left << std::setw(16) << "Phase" << std::right << std::setw(10) << "Calls" << std::setw(12) << "Total ms"
+			<< std::setw(12) << "Mean us" << std::setw(12) << "Min us" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "Max us" << std::endl;
+		for (const auto& phase : phases)
+		{
+			const PhaseStats& stats = phase.second;
+			table << std::left << std::setw(16) << phase.first << std::right << std::fixed << std::setprecision(2)
+				<< std::setw(10) << stats.count
+				<< std::setw(12) << stats.total / 1000000.0
+				<< std::setw(12) << stats.total / 1000.0 / std::max(1LL, stats.count)
+				<< std::setw(12) << stats.min / 1000.0
+				<< std::setw(12) << GetPercentile(stats, 0.5) / 1000.0
+				<< std::setw(12) << GetPercentile(stats, 0.99) / 1000.0
+				<< std::setw(12) << stats.max / 1000.0 << std::endl;
+		}
+		for (const auto& counter : counters)
+		{
+			table << std::left << std::setw(16) << counter.first << std::right << std::setw(10) << counter.second << std::endl;
+		}
+		summary << table.str() << std::flush;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "DEFINITIONS.hpp"
+
+namespace Sonar
+{
+	//Per tick phase timing. Each thread records into its own buffer without locking, and the buffers are merged
+	//into a Chrome trace (chrome://tracing) and a summary table at the end of a generation
+	class Profiler
+	{
+	public:
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled();
+
+		//Nanoseconds since the profiler started
+		static long long Now();
+
+		static void Record(const char* name, long long start, long long duration);
+		static void Count(const char* name, long long amount);
+
+		//Writes the trace file and the summary table, then clears every buffer.
+		//Call it between ticks, while no other thread is recording
+		static void Dump(const std::string& traceFileName, std::ostream& summary);
+	};
+
+	//Records the time between construction and destruction under the given name. name must be a string literal
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(const char* name) : _name(name), _start(Profiler::IsEnabled() ? Profiler::Now() : -1) { }
+		~ScopedTimer()
+		{
+			if (_start >= 0)
+				Profiler::Record(_name, _start, Profiler::Now() - _start);
+		}
+
+	private:
+		const char* _name;
+		long long _start;
+	};
+}
+
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+
+#if PROFILING_ENABLED
+#define PROFILE_SCOPE(name) Sonar::ScopedTimer PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+#define PROFILE_COUNT(name, amount) do { if (Sonar::Profiler::IsEnabled()) Sonar::Profiler::Count(name, amount); } while (false)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNT(name, amount) ((void)0)
+#endif
@@ -0,0 +1,418 @@
+#include "QuantizedNetwork.h"
+#include "Activation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUANTIZED_SSE2 1
+#include <emmintrin.h>
+#else
+#define QUANTIZED_SSE2 0
+#endif
+
+//Half precision is widened in hardware when F16C is enabled. MSVC only signals it through /arch:AVX2, every AVX2 processor has it
+#if QUANTIZED_SSE2 && (defined(__F16C__) || defined(__AVX2__))
+#define QUANTIZED_F16C 1
+#include <immintrin.h>
+#else
+#define QUANTIZED_F16C 0
+#endif
+
+//Fixed point scale of the int8 path inputs. Normalised inputs reach ~14.3 when a distance is ERROR_DISTANCE, so 2048 keeps them inside int16
+#define INPUT_FIXED_POINT_SCALE 2048.0f
+//Fixed point scale of the activation outputs fed to the next layer
+#define ACTIVATION_FIXED_POINT_SCALE 32767.0f
+//Largest layer the evaluation scratch buffers can hold
+#define MAX_QUANTIZED_LAYER_SIZE 256
+
+static_assert(QUANTIZED_GROUP_WIDTH == 8, "The SIMD paths evaluate eight networks per group");
+
+namespace
+{
+	short ToFixedPoint(float value, float scale)
+	{
+		float scaled = std::round(value * scale);
+		if (scaled > 32767.0f)
+			scaled = 32767.0f;
+		else if (scaled < -32767.0f)
+			scaled = -32767.0f;
+		return (short)scaled;
+	}
+
+	//Returns the weight node j sends to node k of the next layer
+	float GetWeight(const std::vector<std::vector<Node*>>& nodeNetwork, int layer, int j, int k)
+	{
+		const std::vector<float>* weights;
+		if (layer == 0)
+			weights = &static_cast<InputNode*>(nodeNetwork.at(layer).at(j))->weights;
+		else
+			weights = &static_cast<ActivationNode*>(nodeNetwork.at(layer).at(j))->weights;
+		if (k < (int)weights->size())
+			return weights->at(k);
+		return 0;
+	}
+
+#if QUANTIZED_SSE2
+	//Widens the four half precision values in the low 64 bits to floats
+	__m128 WidenHalves(__m128i halves)
+	{
+#if QUANTIZED_F16C
+		return _mm_cvtph_ps(halves);
+#else
+		//Shift the exponent and mantissa into float position and rebias the exponent. Infinity and NaN keep the top
+		//exponent, zero and subnormal halves are renormalised by subtracting the smallest normal float they now carry
+		const __m128i exponentMask = _mm_set1_epi32(0x7c00 << 13);
+		__m128i bits = _mm_unpacklo_epi16(halves, _mm_setzero_si128());
+		__m128i sign = _mm_slli_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x8000)), 16);
+		__m128i magnitude = _mm_slli_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x7fff)), 13);
+		__m128i exponent = _mm_and_si128(magnitude, exponentMask);
+		magnitude = _mm_add_epi32(magnitude, _mm_set1_epi32((127 - 15) << 23));
+
+		__m128i infinite = _mm_cmpeq_epi32(exponent, exponentMask);
+		magnitude = _mm_add_epi32(magnitude, _mm_and_si128(infinite, _mm_set1_epi32((128 - 16) << 23)));
+
+		__m128 subnormal = _mm_castsi128_ps(_mm_cmpeq_epi32(exponent, _mm_setzero_si128()));
+		__m128 renormalised = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(magnitude, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+		__m128 result = _mm_or_ps(_mm_and_ps(subnormal, renormalised), _mm_andnot_ps(subnormal, _mm_castsi128_ps(magnitude)));
+		return _mm_or_ps(result, _mm_castsi128_ps(sign));
+#endif
+	}
+#endif
+}
+
+QuantizedPopulation::QuantizedPopulation(QuantizationMode p_mode) : mode(p_mode)
+{
+}
+
+bool QuantizedPopulation::AddNetwork(const std::vector<std::vector<Node*>>& nodeNetwork)
+{
+	int layerCount = (int)nodeNetwork.size();
+	if (networkCount == 0)
+	{
+		layerSizes.clear();
+		weightStride = 0;
+		biasStride = 0;
+		for (int i = 0; i < layerCount; i++)
+		{
+			int size = (int)nodeNetwork.at(i).size();
+			if (size > MAX_QUANTIZED_LAYER_SIZE)
+				return false;
+			layerSizes.push_back(size);
+
+			int rows = (i + 1 < layerCount) ? (int)nodeNetwork.at(i + 1).size() : 1;
+			weightStride += rows * size * QUANTIZED_GROUP_WIDTH;
+			if (i > 0)
+				biasStride += size * QUANTIZED_GROUP_WIDTH;
+		}
+		scaleStride = layerCount * QUANTIZED_GROUP_WIDTH;
+	}
+	else
+	{
+		//Every network is evaluated with the same strides
+		if (layerCount != (int)layerSizes.size())
+			return false;
+		for (int i = 0; i < layerCount; i++)
+		{
+			if ((int)nodeNetwork.at(i).size() != layerSizes.at(i))
+				return false;
+		}
+	}
+
+	//A new group starts zeroed, so its unused lanes evaluate to nothing
+	int group = networkCount / QUANTIZED_GROUP_WIDTH;
+	int lane = networkCount % QUANTIZED_GROUP_WIDTH;
+	if (lane == 0)
+	{
+		if (mode == eQuantizeInt8)
+			weightsInt8.resize(weightsInt8.size() + weightStride, 0);
+		else
+			weightsFloat16.resize(weightsFloat16.size() + weightStride, 0);
+		biases.resize(biases.size() + biasStride, 0.0f);
+		scales.resize(scales.size() + scaleStride, 1.0f);
+	}
+	int weightIndex = group * weightStride + lane;
+	int biasIndex = group * biasStride + lane;
+
+	//iterate weight matrices
+	for (int i = 0; i < layerCount; i++)
+	{
+		int rows = (i + 1 < layerCount) ? layerSizes.at(i + 1) : 1;
+
+		//Symmetric per matrix scale, so the largest weight maps to 127
+		float maxWeight = 0;
+		for (int k = 0; k < rows; k++)
+		{
+			for (int j = 0; j < layerSizes.at(i); j++)
+				maxWeight = std::max(maxWeight, std::abs(GetWeight(nodeNetwork, i, j, k)));
+		}
+		float scale = maxWeight > 0 ? maxWeight / 127.0f : 1.0f;
+		scales.at(group * scaleStride + i * QUANTIZED_GROUP_WIDTH + lane) = mode == eQuantizeInt8 ? scale : 1.0f;
+
+		for (int k = 0; k < rows; k++)
+		{
+			for (int j = 0; j < layerSizes.at(i); j++)
+			{
+				float weight = GetWeight(nodeNetwork, i, j, k);
+				if (mode == eQuantizeInt8)
+					weightsInt8.at(weightIndex) = (int8_t)std::round(weight / scale);
+				else
+					weightsFloat16.at(weightIndex) = FloatToHalf(weight);
+				weightIndex += QUANTIZED_GROUP_WIDTH;
+			}
+		}
+
+		if (i > 0)
+		{
+			for (int j = 0; j < layerSizes.at(i); j++)
+			{
+				biases.at(biasIndex) = static_cast<ActivationNode*>(nodeNetwork.at(i).at(j))->bias;
+				biasIndex += QUANTIZED_GROUP_WIDTH;
+			}
+		}
+	}
+
+	networkCount++;
+	return true;
+}
+
+void QuantizedPopulation::Evaluate(const int* networkIndices, int count, const float* inputs, unsigned char* decisions) const
+{
+	if (layerSizes.empty())
+		return;
+	int groupCount = (networkCount + QUANTIZED_GROUP_WIDTH - 1) / QUANTIZED_GROUP_WIDTH;
+	int inputCount = layerSizes.at(0);
+	int groupInputStride = inputCount * QUANTIZED_GROUP_WIDTH;
+	groupInputs.assign(groupCount * groupInputStride, 0.0f);
+	groupListed.assign(groupCount, 0);
+	groupDecisions.resize(groupCount * QUANTIZED_GROUP_WIDTH);
+
+	//Transpose the inputs, each input of a group becomes one row with a lane per network
+	for (int i = 0; i < count; i++)
+	{
+		int group = networkIndices[i] / QUANTIZED_GROUP_WIDTH;
+		float* lane = &groupInputs[group * groupInputStride + networkIndices[i] % QUANTIZED_GROUP_WIDTH];
+		for (int j = 0; j < inputCount; j++)
+			lane[j * QUANTIZED_GROUP_WIDTH] = inputs[i * NETWORK_INPUTS + j];
+		groupListed[group] = 1;
+	}
+
+	//Groups whose birds are all dead are skipped, the dead lanes of the others ride along for free
+	for (int group = 0; group < groupCount; group++)
+	{
+		if (!groupListed[group])
+			continue;
+		if (mode == eQuantizeInt8)
+			EvaluateGroupInt8(group, &groupInputs[group * groupInputStride], &groupDecisions[group * QUANTIZED_GROUP_WIDTH]);
+		else
+			EvaluateGroupFloat16(group, &groupInputs[group * groupInputStride], &groupDecisions[group * QUANTIZED_GROUP_WIDTH]);
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		decisions[networkIndices[i]] = groupDecisions[networkIndices[i]];
+	}
+}
+
+void QuantizedPopulation::EvaluateGroupInt8(int group, const float* inputs, unsigned char* decisions) const
+{
+	short activations[MAX_QUANTIZED_LAYER_SIZE * QUANTIZED_GROUP_WIDTH];
+	float hidden[MAX_QUANTIZED_LAYER_SIZE * QUANTIZED_GROUP_WIDTH];
+	int sums[QUANTIZED_GROUP_WIDTH];
+
+	const int8_t* weights = &weightsInt8[group * weightStride];
+	const float* scale = &scales[group * scaleStride];
+	const float* bias = biasStride > 0 ? &biases[group * biasStride] : nullptr;
+
+	//Quantize the inputs
+	for (int i = 0; i < layerSizes.at(0) * QUANTIZED_GROUP_WIDTH; i++)
+		activations[i] = ToFixedPoint(inputs[i], INPUT_FIXED_POINT_SCALE);
+	float activationScale = 1.0f / INPUT_FIXED_POINT_SCALE;
+
+	int layerCount = (int)layerSizes.size();
+	for (int i = 0; i < layerCount; i++)
+	{
+		int columns = layerSizes.at(i);
+		int rows = (i + 1 < layerCount) ? layerSizes.at(i + 1) : 1;
+		for (int k = 0; k < rows; k++)
+		{
+			const int8_t* row = weights + k * columns * QUANTIZED_GROUP_WIDTH;
+#if QUANTIZED_SSE2
+			//Eight networks per instruction. int16 products are widened to int32 before they're summed
+			__m128i low = _mm_setzero_si128();
+			__m128i high = _mm_setzero_si128();
+			for (int j = 0; j < columns; j++)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(activations + j * QUANTIZED_GROUP_WIDTH));
+				__m128i w = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + j * QUANTIZED_GROUP_WIDTH));
+				//Sign extend 8 weights to int16
+				w = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+				__m128i productLow = _mm_mullo_epi16(a, w);
+				__m128i productHigh = _mm_mulhi_epi16(a, w);
+				low = _mm_add_epi32(low, _mm_unpacklo_epi16(productLow, productHigh));
+				high = _mm_add_epi32(high, _mm_unpackhi_epi16(productLow, productHigh));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(sums), low);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + 4), high);
+#else
+			for (int lane = 0; lane < QUANTIZED_GROUP_WIDTH; lane++)
+			{
+				sums[lane] = 0;
+				for (int j = 0; j < columns; j++)
+					sums[lane] += activations[j * QUANTIZED_GROUP_WIDTH + lane] * row[j * QUANTIZED_GROUP_WIDTH + lane];
+			}
+#endif
+			//Last layer feeds the output node, which only needs the sign
+			if (i + 1 == layerCount)
+			{
+				for (int lane = 0; lane < QUANTIZED_GROUP_WIDTH; lane++)
+					decisions[lane] = sums[lane] >= 0 ? 1 : 0;
+				return;
+			}
+			for (int lane = 0; lane < QUANTIZED_GROUP_WIDTH; lane++)
+			{
+				float sum = sums[lane] * scale[i * QUANTIZED_GROUP_WIDTH + lane] * activationScale;
+				hidden[k * QUANTIZED_GROUP_WIDTH + lane] = Activation::Apply(sum + bias[k * QUANTIZED_GROUP_WIDTH + lane]);
+			}
+		}
+		weights += rows * columns * QUANTIZED_GROUP_WIDTH;
+		bias += rows * QUANTIZED_GROUP_WIDTH;
+
+		//Requantize for the next layer. Every activation but ReLU keeps the values within [-1, 1], and ReLU runs in float
+		for (int m = 0; m < rows * QUANTIZED_GROUP_WIDTH; m++)
+			activations[m] = ToFixedPoint(hidden[m], ACTIVATION_FIXED_POINT_SCALE);
+		activationScale = 1.0f / ACTIVATION_FIXED_POINT_SCALE;
+	}
+}
+
+void QuantizedPopulation::EvaluateGroupFloat16(int group, const float* inputs, unsigned char* decisions) const
+{
+	float activations[MAX_QUANTIZED_LAYER_SIZE * QUANTIZED_GROUP_WIDTH];
+	float sums[QUANTIZED_GROUP_WIDTH];
+
+	const uint16_t* weights = &weightsFloat16[group * weightStride];
+	const float* bias = biasStride > 0 ? &biases[group * biasStride] : nullptr;
+
+	std::copy(inputs, inputs + layerSizes.at(0) * QUANTIZED_GROUP_WIDTH, activations);
+
+	int layerCount = (int)layerSizes.size();
+	for (int i = 0; i < layerCount; i++)
+	{
+		int columns = layerSizes.at(i);
+		int rows = (i + 1 < layerCount) ? layerSizes.at(i + 1) : 1;
+		float hidden[MAX_QUANTIZED_LAYER_SIZE * QUANTIZED_GROUP_WIDTH];
+		for (int k = 0; k < rows; k++)
+		{
+			const uint16_t* row = weights + k * columns * QUANTIZED_GROUP_WIDTH;
+#if QUANTIZED_SSE2
+			//One 16 byte load holds a weight for each of the eight networks, widened four at a time
+			__m128 low = _mm_setzero_ps();
+			__m128 high = _mm_setzero_ps();
+			for (int j = 0; j < columns; j++)
+			{
+				__m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j * QUANTIZED_GROUP_WIDTH));
+				const float* a = activations + j * QUANTIZED_GROUP_WIDTH;
+				low = _mm_add_ps(low, _mm_mul_ps(WidenHalves(halves), _mm_loadu_ps(a)));
+				high = _mm_add_ps(high, _mm_mul_ps(WidenHalves(_mm_srli_si128(halves, 8)), _mm_loadu_ps(a + 4)));
+			}
+			_mm_storeu_ps(sums, low);
+			_mm_storeu_ps(sums + 4, high);
+#else
+			for (int lane = 0; lane < QUANTIZED_GROUP_WIDTH; lane++)
+			{
+				sums[lane] = 0;
+				for (int j = 0; j < columns; j++)
+					sums[lane] += activations[j * QUANTIZED_GROUP_WIDTH + lane] * HalfToFloat(row[j * QUANTIZED_GROUP_WIDTH + lane]);
+			}
+#endif
+			if (i + 1 == layerCount)
+			{
+				for (int lane = 0; lane < QUANTIZED_GROUP_WIDTH; lane++)
+					decisions[lane] = sums[lane] >= 0 ? 1 : 0;
+				return;
+			}
+			for (int lane = 0; lane < QUANTIZED_GROUP_WIDTH; lane++)
+				hidden[k * QUANTIZED_GROUP_WIDTH + lane] = Activation::Apply(sums[lane] + bias[k * QUANTIZED_GROUP_WIDTH + lane]);
+		}
+		weights += rows * columns * QUANTIZED_GROUP_WIDTH;
+		bias += rows * QUANTIZED_GROUP_WIDTH;
+		std::copy(hidden, hidden + rows * QUANTIZED_GROUP_WIDTH, activations);
+	}
+}
+
+void QuantizedPopulation::RecordAgreement(bool quantizedDecision, bool floatDecision)
+{
+	comparedDecisions++;
+	if (quantizedDecision == floatDecision)
+		agreedDecisions++;
+}
+
+float QuantizedPopulation::GetAgreementRate() const
+{
+	if (comparedDecisions == 0)
+		return 1.0f;
+	return (float)((double)agreedDecisions / (double)comparedDecisions);
+}
+
+int QuantizedPopulation::GetNetworkFootprint() const
+{
+	int weightBytes = weightStride * (mode == eQuantizeInt8 ? (int)sizeof(int8_t) : (int)sizeof(uint16_t));
+	//Float16 has no scales to keep
+	int floatCount = biasStride + (mode == eQuantizeInt8 ? scaleStride : 0);
+	return (weightBytes + floatCount * (int)sizeof(float)) / QUANTIZED_GROUP_WIDTH;
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	//Too small even for a subnormal half
+	if (exponent < -10)
+		return sign;
+	//Subnormal half
+	if (exponent <= 0)
+	{
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint16_t half = (uint16_t)(mantissa >> shift);
+		if ((mantissa >> (shift - 1)) & 1)
+			half++;
+		return sign | half;
+	}
+	//Overflow to infinity
+	if (exponent >= 31)
+		return sign | 0x7c00;
+
+	uint16_t half = (uint16_t)(sign | (exponent << 10) | (mantissa >> 13));
+	//Round to nearest, a carry correctly bumps the exponent
+	if (mantissa & 0x1000)
+		half++;
+	return half;
+}
+
+float HalfToFloat(uint16_t value)
+{
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1f;
+	uint32_t mantissa = value & 0x3ff;
+
+	uint32_t bits;
+	if (exponent == 0)
+	{
+		float result = std::ldexp((float)mantissa, -24);
+		return sign ? -result : result;
+	}
+	else if (exponent == 31)
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	else
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Node.h"
+#include "DEFINITIONS.hpp"
+
+//Precision used by the quantized inference engine
+enum QuantizationMode
+{
+	eQuantizeInt8,
+	eQuantizeFloat16
+};
+
+//Networks evaluated side by side, one per SIMD lane
+#define QUANTIZED_GROUP_WIDTH 8
+
+//Flattened, reduced precision copy of a whole population's networks.
+//The weights are converted once per generation. Networks are stored in groups of QUANTIZED_GROUP_WIDTH with every
+//weight interleaved across the group, so each vector multiply-add advances that many birds at once
+class QuantizedPopulation
+{
+public:
+	QuantizedPopulation(QuantizationMode p_mode);
+
+	//Converts a bird's node network and appends it to the population. Returns false if the topology doesn't match the first network
+	bool AddNetwork(const std::vector<std::vector<Node*>>& nodeNetwork);
+
+	//Evaluates the listed networks. inputs holds NETWORK_INPUTS floats per listed network in list order,
+	//each decision is written at its network's own index. Groups without a listed network are skipped
+	void Evaluate(const int* networkIndices, int count, const float* inputs, unsigned char* decisions) const;
+
+	//Agreement tracking against the float path
+	void RecordAgreement(bool quantizedDecision, bool floatDecision);
+	float GetAgreementRate() const;
+	long long GetComparedDecisions() const { return comparedDecisions; }
+
+	int GetNetworkCount() const { return networkCount; }
+	QuantizationMode GetMode() const { return mode; }
+	//Bytes of weight storage per network
+	int GetNetworkFootprint() const;
+
+private:
+	//Evaluate one group. inputs is layerSizes[0] rows of QUANTIZED_GROUP_WIDTH values, decisions gets one per lane
+	void EvaluateGroupInt8(int group, const float* inputs, unsigned char* decisions) const;
+	void EvaluateGroupFloat16(int group, const float* inputs, unsigned char* decisions) const;
+
+	QuantizationMode mode;
+
+	//Topology shared by every network. layerSizes[0] is the input count, the output node is not included
+	std::vector<int> layerSizes;
+
+	int networkCount = 0;
+	//Per group, in elements. A weight is QUANTIZED_GROUP_WIDTH values, one per network of the group
+	int weightStride = 0;
+	int biasStride = 0;
+	int scaleStride = 0;
+
+	//Row-major weight matrices, one row per receiving node (the output node is the last row), each weight interleaved across its group
+	std::vector<int8_t> weightsInt8;
+	std::vector<uint16_t> weightsFloat16;
+	//Per matrix int8 scale and per node bias, interleaved the same way
+	std::vector<float> scales;
+	std::vector<float> biases;
+
+	//Scratch for Evaluate. The population is only ever evaluated by one thread at a time
+	mutable std::vector<float> groupInputs;
+	mutable std::vector<unsigned char> groupListed;
+	mutable std::vector<unsigned char> groupDecisions;
+
+	long long comparedDecisions = 0;
+	long long agreedDecisions = 0;
+};
+
+//IEEE half precision conversion helpers
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
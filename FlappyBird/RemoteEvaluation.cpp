@@ -0,0 +1,363 @@
+#include "RemoteEvaluation.hpp"
+#include "PopulationFile.hpp"
+#include "Activation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+
+//Batches queued on each worker, so the next one is already there when it sends back the last
+#define COORDINATOR_PIPELINE_DEPTH 2
+//How long a generation waits for a worker to connect before it is flown here instead
+#define COORDINATOR_WAIT_SECONDS 10
+//A worker that hasn't answered its oldest batch this long after it could start on it is dropped
+#define COORDINATOR_BATCH_TIMEOUT_SECONDS 60
+#define REMOTE_PROTOCOL_VERSION 1
+
+namespace Sonar
+{
+	enum RemoteMessages
+	{
+		eRemoteConfig = 1,
+		eRemoteBatch,
+		eRemoteScores
+	};
+
+	bool Coordinator::Listen(const RunConfig& config)
+	{
+		_workerConfig = config;
+		_batchSize = config.batchSize;
+
+		//Workers only fly, anything that would start another mode or more workers is cleared
+		_workerConfig.workers = 0;
+		_workerConfig.coordinatorPort = 0;
+		_workerConfig.maxGenerations = 0;
+		_workerConfig.sweepFile = "";
+		_workerConfig.benchmarkFile = "";
+		_workerConfig.throughputFile = "";
+		_workerConfig.replayFile = "";
+		_workerConfig.replayEpoch = "";
+		_workerConfig.profile = false;
+
+		if (_listener.listen((unsigned short)config.coordinatorPort) != sf::Socket::Done)
+		{
+			std::cout << "Error Listening On Port " << config.coordinatorPort << std::endl;
+			return false;
+		}
+		_selector.add(_listener);
+		_listening = true;
+		std::cout << "Waiting for workers on port " << config.coordinatorPort << std::endl;
+		return true;
+	}
+
+	bool Coordinator::Evaluate(const std::vector<Bird*>& birds, unsigned int courseSeed, int generation, std::vector<int>& scores)
+	{
+		if (!_listening || birds.empty())
+			return false;
+		if (IsIdle())
+		{
+			//Don't wait again, take a worker only if one is already trying to connect
+			if (_selector.wait(sf::milliseconds(1)) && _selector.isReady(_listener))
+				AcceptWorker();
+			if (_connections.empty())
+				return false;
+		}
+
+		std::vector<uint32_t> layerSizes;
+		std::vector<float> parameters;
+		if (!PopulationFile::PackNetworks(birds, layerSizes, parameters))
+			return false;
+		size_t genomeParameters = parameters.size() / birds.size();
+
+		int birdCount = (int)birds.size();
+		int batchCount = (birdCount + _batchSize - 1) / _batchSize;
+		std::deque<int> queue(batchCount);
+		std::iota(queue.begin(), queue.end(), 0);
+		std::vector<char> batchDone(batchCount, 0);
+		int remaining = batchCount;
+		scores.assign(birds.size(), -1);
+
+		sf::Clock idleClock;
+		while (remaining > 0)
+		{
+			for (auto& connection : _connections)
+			{
+				while (connection.pending.size() < COORDINATOR_PIPELINE_DEPTH && !queue.empty())
+				{
+					int batch = queue.front();
+					int first = batch * _batchSize;
+					int count = std::min(_batchSize, birdCount - first);
+
+					sf::Packet packet;
+					packet << (sf::Uint8)eRemoteBatch << (sf::Uint32)batch << (sf::Uint32)courseSeed << (sf::Int32)generation
+						<< (sf::Uint32)layerSizes.size();
+					for (uint32_t layerSize : layerSizes)
+					{
+						packet << (sf::Uint32)layerSize;
+					}
+					packet << (sf::Uint32)count;
+					for (size_t i = first * genomeParameters; i < (first + count) * genomeParameters; i++)
+					{
+						packet << parameters.at(i);
+					}
+					//A worker that can't be sent to shows up as disconnected below
+					if (connection.socket->send(packet) != sf::Socket::Done)
+						break;
+					connection.pending.push_back({ batch, _clock.getElapsedTime() });
+					queue.pop_front();
+				}
+			}
+
+			if (!_connections.empty())
+				idleClock.restart();
+			else if (idleClock.getElapsedTime().asSeconds() > COORDINATOR_WAIT_SECONDS)
+			{
+				std::cout << "No workers connected, flying generations here until one does" << std::endl;
+				_idle = true;
+				return false;
+			}
+
+			DropStalledWorkers(queue);
+			if (!_selector.wait(sf::milliseconds(100)))
+				continue;
+			if (_selector.isReady(_listener))
+				AcceptWorker();
+
+			for (int i = (int)_connections.size() - 1; i >= 0; i--)
+			{
+				Connection& connection = _connections.at(i);
+				if (!_selector.isReady(*connection.socket))
+					continue;
+
+				sf::Packet packet;
+				if (connection.socket->receive(packet) != sf::Socket::Done)
+				{
+					std::cout << "Worker " << connection.socket->getRemoteAddress() << " disconnected, requeueing "
+						<< connection.pending.size() << " batches" << std::endl;
+					DropConnection(i, queue);
+					continue;
+				}
+
+				sf::Uint8 type = 0;
+				sf::Uint32 batch = 0, count = 0;
+				packet >> type >> batch >> count;
+				auto sent = std::find_if(connection.pending.begin(), connection.pending.end(),
+					[batch](const PendingBatch& pending) { return pending.batch == (int)batch; });
+				if (!packet || type != eRemoteScores || sent == connection.pending.end()
+					|| (int)count != std::min(_batchSize, birdCount - (int)batch * _batchSize))
+				{
+					std::cout << "Error Reading Scores From Worker " << connection.socket->getRemoteAddress() << std::endl;
+					DropConnection(i, queue);
+					continue;
+				}
+
+				std::vector<int> batchScores(count);
+				for (auto& score : batchScores)
+				{
+					sf::Int32 value = -1;
+					packet >> value;
+					score = value;
+				}
+				if (!packet)
+				{
+					std::cout << "Error Reading Scores From Worker " << connection.socket->getRemoteAddress() << std::endl;
+					DropConnection(i, queue);
+					continue;
+				}
+
+				connection.pending.erase(sent);
+				//The next batch only starts now, its deadline counts from here
+				if (!connection.pending.empty())
+					connection.pending.front().started = std::max(connection.pending.front().started, _clock.getElapsedTime());
+				if (!batchDone.at(batch))
+				{
+					std::copy(batchScores.begin(), batchScores.end(), scores.begin() + batch * _batchSize);
+					batchDone.at(batch) = 1;
+					remaining--;
+				}
+			}
+		}
+		return true;
+	}
+
+	void Coordinator::AcceptWorker()
+	{
+		std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+		if (_listener.accept(*socket) != sf::Socket::Done)
+			return;
+
+		//The worker keeps its own threads, directories and logging
+		nlohmann::json settings = _workerConfig.ToJson();
+		for (const char* key : { "Threads", "EpochDirectory", "StatsFile", "Headless", "Coordinator", "LogLevel", "LogCountersOnly" })
+		{
+			settings.erase(key);
+		}
+		sf::Packet packet;
+		packet << (sf::Uint8)eRemoteConfig << (sf::Uint32)REMOTE_PROTOCOL_VERSION << settings.dump();
+		if (socket->send(packet) != sf::Socket::Done)
+			return;
+
+		std::cout << "Worker connected from " << socket->getRemoteAddress() << std::endl;
+		_idle = false;
+		_selector.add(*socket);
+		Connection connection;
+		connection.socket = std::move(socket);
+		_connections.push_back(std::move(connection));
+	}
+
+	void Coordinator::DropConnection(int index, std::deque<int>& queue)
+	{
+		Connection& connection = _connections.at(index);
+		for (auto pending = connection.pending.rbegin(); pending != connection.pending.rend(); ++pending)
+		{
+			queue.push_front(pending->batch);
+		}
+		_selector.remove(*connection.socket);
+		connection.socket->disconnect();
+		_connections.erase(_connections.begin() + index);
+	}
+
+	void Coordinator::DropStalledWorkers(std::deque<int>& queue)
+	{
+		sf::Time now = _clock.getElapsedTime();
+		for (int i = (int)_connections.size() - 1; i >= 0; i--)
+		{
+			Connection& connection = _connections.at(i);
+			if (connection.pending.empty() || (now - connection.pending.front().started).asSeconds() < COORDINATOR_BATCH_TIMEOUT_SECONDS)
+				continue;
+			std::cout << "Worker " << connection.socket->getRemoteAddress() << " stopped answering, requeueing "
+				<< connection.pending.size() << " batches" << std::endl;
+			DropConnection(i, queue);
+		}
+	}
+
+	bool RemoteWorker::Connect(const std::string& address)
+	{
+		size_t separator = address.rfind(':');
+		if (separator == std::string::npos)
+		{
+			std::cout << "Error Reading Coordinator Address " << address << ", expected host:port" << std::endl;
+			return false;
+		}
+		sf::IpAddress host(address.substr(0, separator));
+		unsigned short port = (unsigned short)std::atoi(address.substr(separator + 1).c_str());
+		if (_socket.connect(host, port, sf::seconds(1)) != sf::Socket::Done)
+			return false;
+
+		_selector.add(_socket);
+		_connected = true;
+		return true;
+	}
+
+	bool RemoteWorker::ReceiveBatch(RunConfig& config, sf::Time timeout)
+	{
+		if (!_connected || !_selector.wait(timeout))
+			return false;
+
+		sf::Packet packet;
+		if (_socket.receive(packet) != sf::Socket::Done)
+		{
+			Disconnect();
+			return false;
+		}
+
+		sf::Uint8 type = 0;
+		packet >> type;
+		if (type == eRemoteConfig)
+		{
+			sf::Uint32 version = 0;
+			std::string settings;
+			packet >> version >> settings;
+			nlohmann::json data = nlohmann::json::parse(settings, nullptr, false);
+			if (!packet || version != REMOTE_PROTOCOL_VERSION || data.is_discarded())
+			{
+				std::cout << "Error Reading Coordinator Settings, protocol version " << version << std::endl;
+				Disconnect();
+				return false;
+			}
+			config.FromJson(data);
+			Activation::Select(Activation::ParseType(config.activation));
+			return false;
+		}
+
+		sf::Uint32 id = 0, courseSeed = 0, layerCount = 0, genomeCount = 0;
+		sf::Int32 generation = 0;
+		packet >> id >> courseSeed >> generation >> layerCount;
+
+		//The counts come off the wire, nothing is allocated until they're known to fit in the packet
+		uint64_t packetFloats = packet.getDataSize() / sizeof(float);
+		bool sizesValid = layerCount <= packet.getDataSize() / sizeof(sf::Uint32);
+		_batch.layerSizes.assign(sizesValid ? layerCount : 0, 0);
+		for (auto& layerSize : _batch.layerSizes)
+		{
+			sf::Uint32 value = 0;
+			packet >> value;
+			layerSize = value;
+			if (value > packetFloats)
+				sizesValid = false;
+		}
+		//Each node's weights into the next layer, or its single output weight, plus a bias past the input layer
+		uint64_t genomeParameters = 0;
+		for (uint32_t i = 0; i < layerCount && sizesValid; i++)
+		{
+			uint64_t weightCount = i + 1 < layerCount ? _batch.layerSizes.at(i + 1) : 1;
+			genomeParameters += _batch.layerSizes.at(i) * (weightCount + (i > 0 ? 1 : 0));
+			if (genomeParameters > packetFloats)
+				sizesValid = false;
+		}
+		packet >> genomeCount;
+		if (sizesValid && genomeParameters > 0 && genomeCount > packetFloats / genomeParameters)
+			sizesValid = false;
+		if (!packet || type != eRemoteBatch || !sizesValid)
+		{
+			std::cout << "Error Reading Batch From Coordinator" << std::endl;
+			Disconnect();
+			return false;
+		}
+
+		_batch.parameters.assign((size_t)(genomeParameters * genomeCount), 0.0f);
+		for (auto& parameter : _batch.parameters)
+		{
+			packet >> parameter;
+		}
+		if (!packet || !packet.endOfPacket())
+		{
+			std::cout << "Error Reading Batch From Coordinator" << std::endl;
+			Disconnect();
+			return false;
+		}
+
+		_batch.id = id;
+		_batch.courseSeed = courseSeed;
+		_batch.generation = generation;
+		_batch.genomeCount = (int)genomeCount;
+		_hasBatch = true;
+		return true;
+	}
+
+	void RemoteWorker::FinishBatch(const std::vector<int>& scores)
+	{
+		sf::Packet packet;
+		packet << (sf::Uint8)eRemoteScores << _batch.id << (sf::Uint32)scores.size();
+		for (int score : scores)
+		{
+			packet << (sf::Int32)score;
+		}
+		if (_socket.send(packet) != sf::Socket::Done)
+			Disconnect();
+		_hasBatch = false;
+	}
+
+	void RemoteWorker::Disconnect()
+	{
+		if (_connected)
+		{
+			_selector.remove(_socket);
+			_socket.disconnect();
+			_finished = true;
+		}
+		_connected = false;
+		_hasBatch = false;
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <SFML/Network.hpp>
+
+#include "RunConfig.hpp"
+
+namespace Sonar
+{
+	//Game.hpp holds the connections, and Bird.hpp includes Game.hpp
+	class Bird;
+
+	//Genomes sent to a worker in one message, laid out like a PopulationFile
+	struct EvaluationBatch
+	{
+		sf::Uint32 id = 0;
+		unsigned int courseSeed = 0;
+		int generation = 0;
+		int genomeCount = 0;
+		std::vector<uint32_t> layerSizes;
+		std::vector<float> parameters;
+	};
+
+	//Flies generations on worker processes connected over TCP, which can be on other machines. Evolution stays here,
+	//workers only get batches of genomes and the course seed and send back the scores. Each worker has a few batches
+	//queued so it never waits on the network, and the batches of a worker that disconnects go to the others
+	class Coordinator
+	{
+	public:
+		//Starts listening on the config's coordinator port
+		bool Listen(const RunConfig& config);
+		bool IsListening() const { return _listening; }
+		int GetWorkerCount() const { return (int)_connections.size(); }
+		//Nobody connected the last time a generation waited. Evaluate then only takes workers that are already
+		//waiting to connect, and fails straight away if there are none
+		bool IsIdle() const { return _listening && _idle && _connections.empty(); }
+
+		//scores gets one entry per bird. Returns false if there are no workers left to fly the generation
+		bool Evaluate(const std::vector<Bird*>& birds, unsigned int courseSeed, int generation, std::vector<int>& scores);
+
+	private:
+		struct PendingBatch
+		{
+			int batch;
+			//When the worker could start on it, the send time or when the batch before it was answered
+			sf::Time started;
+		};
+
+		struct Connection
+		{
+			std::unique_ptr<sf::TcpSocket> socket;
+			//Batches sent and not answered yet, oldest first
+			std::deque<PendingBatch> pending;
+		};
+
+		//Takes a waiting worker off the listener and sends it the simulation settings
+		void AcceptWorker();
+		//Puts the connection's pending batches back in the queue
+		void DropConnection(int index, std::deque<int>& queue);
+		//Drops the workers whose oldest batch is past its deadline, they're connected but not answering
+		void DropStalledWorkers(std::deque<int>& queue);
+
+		RunConfig _workerConfig;
+		int _batchSize = 1;
+		bool _listening = false;
+		bool _idle = false;
+
+		sf::Clock _clock;
+		sf::TcpListener _listener;
+		sf::SocketSelector _selector;
+		std::vector<Connection> _connections;
+	};
+
+	//The worker end. Connects to a coordinator and hands its batches to GameState one at a time
+	class RemoteWorker
+	{
+	public:
+		//address is host:port
+		bool Connect(const std::string& address);
+		bool IsConnected() const { return _connected; }
+		//The coordinator was reached once and has since closed the connection
+		bool IsFinished() const { return _finished; }
+
+		//Waits up to timeout for the next batch. Settings sent by the coordinator are applied to config on the way
+		bool ReceiveBatch(RunConfig& config, sf::Time timeout);
+		bool HasBatch() const { return _hasBatch; }
+		const EvaluationBatch& GetBatch() const { return _batch; }
+
+		//Sends the scores of the current batch back, one per genome
+		void FinishBatch(const std::vector<int>& scores);
+
+	private:
+		void Disconnect();
+
+		sf::TcpSocket _socket;
+		sf::SocketSelector _selector;
+		EvaluationBatch _batch;
+		bool _hasBatch = false;
+		bool _connected = false;
+		bool _finished = false;
+	};
+}
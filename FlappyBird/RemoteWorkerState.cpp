@@ -0,0 +1,65 @@
+#include "RemoteWorkerState.hpp"
+#include "GameState.hpp"
+
+#include <iostream>
+
+//The coordinator may still be starting, each attempt waits up to a second
+#define REMOTE_CONNECT_ATTEMPTS 30
+
+namespace Sonar
+{
+	RemoteWorkerState::RemoteWorkerState(GameDataRef data) : _data(data)
+	{
+
+	}
+
+	void RemoteWorkerState::Init()
+	{
+
+	}
+
+	void RemoteWorkerState::HandleInput()
+	{
+		sf::Event event;
+
+		while (this->_data->window.pollEvent(event))
+		{
+			if (sf::Event::Closed == event.type)
+			{
+				this->_data->window.close();
+			}
+		}
+	}
+
+	void RemoteWorkerState::Update(float dt)
+	{
+		RemoteWorker& worker = _data->remoteWorker;
+		if (worker.IsFinished())
+		{
+			std::cout << "Coordinator closed the connection" << std::endl;
+			this->_data->window.close();
+			return;
+		}
+
+		if (!worker.IsConnected())
+		{
+			if (worker.Connect(_data->config.coordinator))
+				std::cout << "Connected to coordinator " << _data->config.coordinator << std::endl;
+			else if (++_connectAttempts >= REMOTE_CONNECT_ATTEMPTS)
+			{
+				std::cout << "Error Connecting To Coordinator " << _data->config.coordinator << std::endl;
+				this->_data->window.close();
+			}
+			return;
+		}
+
+		if (worker.ReceiveBatch(_data->config, sf::milliseconds(100)))
+			this->_data->machine.AddState(new GameState(_data), true);
+	}
+
+	void RemoteWorkerState::Draw(float dt)
+	{
+		this->_data->window.clear();
+		this->_data->window.display();
+	}
+}
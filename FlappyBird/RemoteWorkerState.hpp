@@ -0,0 +1,26 @@
+#pragma once
+
+#include "State.hpp"
+#include "Game.hpp"
+
+namespace Sonar
+{
+	//Runs between batches on a worker. Connects to the coordinator, then waits for the next batch of genomes and
+	//hands it to a GameState, which comes back here once the batch has flown
+	class RemoteWorkerState : public State
+	{
+	public:
+		RemoteWorkerState(GameDataRef data);
+
+		void Init();
+
+		void HandleInput();
+		void Update(float dt);
+		void Draw(float dt);
+
+	private:
+		GameDataRef _data;
+
+		int _connectAttempts = 0;
+	};
+}
@@ -0,0 +1,92 @@
+#include "Replay.hpp"
+
+#include <fstream>
+#include <iostream>
+
+//library for json files, namepspace definition
+#include "nlohmann/json.hpp"
+using json = nlohmann::json;
+
+namespace Sonar
+{
+	void Replay::SetFlap(int tick)
+	{
+		if (tick / 32 >= (int)flaps.size())
+			flaps.resize(tick / 32 + 1, 0);
+		flaps.at(tick / 32) |= 1u << (tick % 32);
+	}
+
+	bool Replay::GetFlap(int tick) const
+	{
+		if (tick < 0 || tick / 32 >= (int)flaps.size())
+			return false;
+		return (flaps.at(tick / 32) >> (tick % 32)) & 1u;
+	}
+
+	bool Replay::Save(const std::string& fileName) const
+	{
+		const char* digits = "0123456789abcdef";
+		std::string stream;
+		stream.reserve((ticks + 3) / 4);
+		for (int tick = 0; tick < ticks; tick += 4)
+		{
+			int nibble = 0;
+			for (int bit = 0; bit < 4; bit++)
+			{
+				if (GetFlap(tick + bit))
+					nibble |= 1 << bit;
+			}
+			stream += digits[nibble];
+		}
+
+		json replayData;
+		replayData["Generation"] = generation;
+		replayData["CourseSeed"] = courseSeed;
+		replayData["Score"] = score;
+		replayData["Ticks"] = ticks;
+		replayData["Flaps"] = stream;
+
+		std::ofstream outputFile(fileName);
+		if (!outputFile.good())
+		{
+			std::cout << "Error Writing Replay " << fileName << std::endl;
+			return false;
+		}
+		outputFile << replayData;
+		return true;
+	}
+
+	bool Replay::Load(const std::string& fileName)
+	{
+		std::ifstream inputFile(fileName);
+		if (!inputFile.good())
+		{
+			std::cout << "Error Loading Replay " << fileName << std::endl;
+			return false;
+		}
+		json replayData = json::parse(inputFile, nullptr, false);
+		if (replayData.is_discarded())
+		{
+			std::cout << "Error Reading Replay " << fileName << std::endl;
+			return false;
+		}
+
+		generation = replayData.value("Generation", 0);
+		courseSeed = replayData.value("CourseSeed", 0u);
+		score = replayData.value("Score", 0);
+		ticks = replayData.value("Ticks", 0);
+		flaps.clear();
+		std::string stream = replayData.value("Flaps", std::string());
+		for (int i = 0; i < (int)stream.size(); i++)
+		{
+			char digit = stream.at(i);
+			int nibble = digit >= 'a' ? digit - 'a' + 10 : digit - '0';
+			for (int bit = 0; bit < 4; bit++)
+			{
+				if (nibble & (1 << bit))
+					SetFlap(i * 4 + bit);
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Sonar
+{
+	//One bird's flight, enough to play it back exactly: the seed of the course it flew and one bit per tick
+	//for whether it flapped. The rest of the simulation is deterministic, so nothing else needs storing
+	struct Replay
+	{
+		int generation = 0;
+		unsigned int courseSeed = 0;
+		int score = 0;
+		//Ticks the bird was alive for, the stream holds at least this many bits
+		int ticks = 0;
+		std::vector<uint32_t> flaps;
+
+		void SetFlap(int tick);
+		bool GetFlap(int tick) const;
+
+		//Json with the flap stream as a hex string, a few kilobytes for a full generation
+		bool Save(const std::string& fileName) const;
+		bool Load(const std::string& fileName);
+	};
+}
@@ -0,0 +1,211 @@
+#include "ReplayState.hpp"
+#include "DEFINITIONS.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace Sonar
+{
+	ReplayState::ReplayState(GameDataRef data, const std::string& fileName) : _data(data), _fileName(fileName)
+	{
+		_speed = _data->config.replaySpeed;
+	}
+
+	ReplayState::~ReplayState()
+	{
+		if (_pipe != nullptr)
+			delete _pipe;
+		if (_land != nullptr)
+			delete _land;
+		if (_bird != nullptr)
+			delete _bird;
+		if (_hud != nullptr)
+			delete _hud;
+	}
+
+	void ReplayState::Init()
+	{
+		if (!_replay.Load(_fileName))
+		{
+			this->_data->window.close();
+			return;
+		}
+
+		this->_data->assets.LoadTexture("Game Background", GAME_BACKGROUND_FILEPATH);
+		this->_data->assets.LoadTexture("Pipe Up", PIPE_UP_FILEPATH);
+		this->_data->assets.LoadTexture("Pipe Down", PIPE_DOWN_FILEPATH);
+		this->_data->assets.LoadTexture("Land", LAND_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 1", BIRD_FRAME_1_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 2", BIRD_FRAME_2_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 3", BIRD_FRAME_3_FILEPATH);
+		this->_data->assets.LoadTexture("Bird Frame 4", BIRD_FRAME_4_FILEPATH);
+		this->_data->assets.LoadTexture("Scoring Pipe", SCORING_PIPE_FILEPATH);
+		this->_data->assets.LoadFont("Flappy Font", FLAPPY_FONT_FILEPATH);
+
+		_background.setTexture(this->_data->assets.GetTexture("Game Background"));
+
+		_pipe = new Pipe(_data);
+		_land = new Land(_data);
+		//The flap stream stands in for the network
+		_bird = new Bird(_data, std::vector<std::vector<Node*>>());
+		_hud = new HUD(_data);
+
+		_pipe->SetCourseSeed(_replay.courseSeed);
+		_scoreLineX = _bird->GetSprite().getPosition().x + 0.625f * 0.5f * _bird->GetSprite().getLocalBounds().width;
+		_snapshots.push_back(Snapshot{ 0, 0, *_pipe, *_land, _bird->GetMotion() });
+
+		_infoText.setFont(this->_data->assets.GetFont("Flappy Font"));
+		_infoText.setCharacterSize(20);
+		_infoText.setFillColor(sf::Color::White);
+		_infoText.setOutlineColor(sf::Color::Black);
+		_infoText.setOutlineThickness(1.0f);
+		_infoText.setPosition(sf::Vector2f(10.0f, (float)_data->window.getSize().y - 40.0f));
+
+		std::cout << "Replaying generation " << _replay.generation << ", score " << _replay.score << " over " << _replay.ticks << " ticks" << std::endl;
+		UpdateInfo();
+	}
+
+	void ReplayState::HandleInput()
+	{
+		sf::Event event;
+		while (this->_data->window.pollEvent(event))
+		{
+			if (sf::Event::Closed == event.type)
+			{
+				this->_data->window.close();
+			}
+
+			if (sf::Event::KeyPressed == event.type && _bird != nullptr)
+			{
+				int seekTicks = SECONDS_TO_TICKS(REPLAY_SEEK_SECONDS);
+				switch (event.key.code)
+				{
+				case sf::Keyboard::Space:
+					_paused = !_paused;
+					break;
+				case sf::Keyboard::Up:
+					_speed *= 2.0f;
+					break;
+				case sf::Keyboard::Down:
+					_speed /= 2.0f;
+					break;
+				case sf::Keyboard::Right:
+					Seek(_tick + seekTicks);
+					break;
+				case sf::Keyboard::Left:
+					Seek(_tick - seekTicks);
+					break;
+				case sf::Keyboard::Home:
+					Seek(0);
+					break;
+				default:
+					break;
+				}
+				UpdateInfo();
+			}
+		}
+	}
+
+	void ReplayState::Update(float dt)
+	{
+		if (_bird == nullptr || _paused || _tick >= _replay.ticks)
+			return;
+
+		_tickBudget += _speed;
+		int startTick = _tick;
+		while (_tickBudget >= 1.0f && _tick < _replay.ticks)
+		{
+			StepTick();
+			_tickBudget -= 1.0f;
+		}
+		if (_tick >= _replay.ticks)
+			_tickBudget = 0.0f;
+		if (_tick != startTick)
+			UpdateInfo();
+	}
+
+	void ReplayState::Draw(float dt)
+	{
+		this->_data->window.clear(sf::Color::Red);
+
+		this->_data->window.draw(this->_background);
+
+		if (_bird != nullptr)
+		{
+			_pipe->DrawPipes();
+			_land->DrawLand();
+			_bird->Draw();
+			_hud->Draw();
+			this->_data->window.draw(_infoText);
+		}
+
+		this->_data->window.display();
+	}
+
+	void ReplayState::StepTick()
+	{
+		float dt = TICK_DURATION;
+		if (_replay.GetFlap(_tick))
+			_bird->Tap();
+
+		_bird->Animate(dt);
+		_land->MoveLand(dt);
+		_pipe->MovePipes(dt);
+
+		_pipeSpawnTicks++;
+		if (_pipeSpawnTicks > SECONDS_TO_TICKS(PIPE_SPAWN_FREQUENCY / GAME_SPEED))
+		{
+			_pipe->RandomisePipeOffset();
+
+			_pipe->SpawnInvisiblePipe();
+			_pipe->SpawnBottomPipe();
+			_pipe->SpawnTopPipe();
+			_pipe->SpawnScoringPipe();
+
+			_pipeSpawnTicks = 0;
+		}
+		_bird->Update(dt);
+		_tick++;
+
+		if (_tick % REPLAY_SNAPSHOT_INTERVAL == 0 && _tick / REPLAY_SNAPSHOT_INTERVAL == (int)_snapshots.size())
+			_snapshots.push_back(Snapshot{ _tick, _pipeSpawnTicks, *_pipe, *_land, _bird->GetMotion() });
+	}
+
+	void ReplayState::Seek(int tick)
+	{
+		tick = std::max(0, std::min(tick, _replay.ticks));
+
+		//Going forward from where we are is never slower than going forward from an older snapshot
+		int snapshot = std::min(tick / REPLAY_SNAPSHOT_INTERVAL, (int)_snapshots.size() - 1);
+		if (tick < _tick || _snapshots.at(snapshot).tick > _tick)
+		{
+			const Snapshot& restore = _snapshots.at(snapshot);
+			_tick = restore.tick;
+			_pipeSpawnTicks = restore.pipeSpawnTicks;
+			*_pipe = restore.pipe;
+			*_land = restore.land;
+			_bird->SetMotion(restore.motion);
+		}
+		while (_tick < tick)
+		{
+			StepTick();
+		}
+		_tickBudget = 0.0f;
+	}
+
+	void ReplayState::UpdateInfo()
+	{
+		_hud->UpdateScore(_pipe->CountColumnsPassed(_scoreLineX));
+
+		std::ostringstream text;
+		text << "Generation " << _replay.generation << "   " << std::fixed << std::setprecision(1)
+			<< _tick * TICK_DURATION << "/" << _replay.ticks * TICK_DURATION << "s   x" << std::setprecision(2) << _speed;
+		if (_paused)
+			text << "   paused";
+		else if (_tick >= _replay.ticks)
+			text << "   end";
+		_infoText.setString(text.str());
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "State.hpp"
+#include "Game.hpp"
+#include "Pipe.hpp"
+#include "Land.hpp"
+#include "Bird.hpp"
+#include "HUD.hpp"
+#include "Replay.hpp"
+
+namespace Sonar
+{
+	//Plays a recorded flight back by flying the same course and replaying the flap stream. Space pauses,
+	//up and down change the speed, left and right seek, home restarts
+	class ReplayState : public State
+	{
+	public:
+		ReplayState(GameDataRef data, const std::string& fileName);
+		~ReplayState() override;
+
+		void Init();
+
+		void HandleInput();
+		void Update(float dt);
+		void Draw(float dt);
+
+	private:
+		//Everything a tick changes, taken every REPLAY_SNAPSHOT_INTERVAL ticks the first time playback passes them
+		struct Snapshot
+		{
+			int tick;
+			int pipeSpawnTicks;
+			Pipe pipe;
+			Land land;
+			Bird::Motion motion;
+		};
+
+		//Plays one tick in the same order GameState::Update does
+		void StepTick();
+		//Restores the nearest snapshot at or before the tick and simulates forward from it without drawing
+		void Seek(int tick);
+		void UpdateInfo();
+
+		GameDataRef _data;
+		std::string _fileName;
+		Replay _replay;
+
+		sf::Sprite _background;
+		sf::Text _infoText;
+
+		Pipe* _pipe = nullptr;
+		Land* _land = nullptr;
+		Bird* _bird = nullptr;
+		HUD* _hud = nullptr;
+
+		std::vector<Snapshot> _snapshots;
+
+		int _tick = 0;
+		int _pipeSpawnTicks = 0;
+		float _scoreLineX = 0.0f;
+
+		float _speed = 1.0f;
+		//Fraction of a tick carried over between frames, so speeds below 1 still advance
+		float _tickBudget = 0.0f;
+		bool _paused = false;
+	};
+}
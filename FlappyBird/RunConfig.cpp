@@ -0,0 +1,285 @@
+#include "RunConfig.hpp"
+#include "Activation.h"
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+
+namespace Sonar
+{
+	namespace
+	{
+		//--population-size -> PopulationSize
+		std::string ArgumentToKey(const std::string& argument)
+		{
+			std::string key;
+			bool capitalize = true;
+			for (unsigned int i = 2; i < argument.size(); i++)
+			{
+				if (argument.at(i) == '-')
+				{
+					capitalize = true;
+					continue;
+				}
+				key += capitalize ? (char)std::toupper(argument.at(i)) : argument.at(i);
+				capitalize = false;
+			}
+			return key;
+		}
+	}
+
+	void RunConfig::Load(int argc, char** argv)
+	{
+		if (argc > 0)
+			executable = argv[0];
+		std::string fileName = "config.json";
+		for (int i = 1; i + 1 < argc; i++)
+		{
+			if (std::string(argv[i]) == "--config")
+				fileName = argv[i + 1];
+		}
+		LoadFile(fileName);
+		ApplyArguments(argc, argv);
+	}
+
+	bool RunConfig::LoadFile(const std::string& fileName)
+	{
+		std::ifstream configFile(fileName);
+		if (!configFile.good())
+			return false; //No config file, keep the defaults
+
+		nlohmann::json data = nlohmann::json::parse(configFile, nullptr, false);
+		if (data.is_discarded() || !data.is_object())
+		{
+			std::cout << "Error Loading Config " << fileName << std::endl;
+			return false;
+		}
+		FromJson(data);
+		return true;
+	}
+
+	void RunConfig::ApplyArguments(int argc, char** argv)
+	{
+		nlohmann::json overrides;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string argument = argv[i];
+			if (argument.size() < 3 || argument.compare(0, 2, "--") != 0)
+				continue;
+			if (argument == "--config")
+			{
+				i++;
+				continue;
+			}
+
+			//Flags without a value are switches
+			std::string value = "true";
+			if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+			{
+				value = argv[i + 1];
+				i++;
+			}
+
+			//Numbers and booleans parse as json, anything else is kept as a string
+			nlohmann::json parsedValue = nlohmann::json::parse(value, nullptr, false);
+			if (parsedValue.is_discarded())
+				parsedValue = value;
+			overrides[ArgumentToKey(argument)] = parsedValue;
+		}
+		if (!overrides.empty())
+			FromJson(overrides);
+	}
+
+	nlohmann::json RunConfig::ToJson() const
+	{
+		nlohmann::json data;
+		data["PopulationSize"] = populationSize;
+		data["EliteSize"] = eliteSize;
+		data["MatingPoolSize"] = matingPoolSize;
+		data["CrossoverRate"] = crossoverRate;
+		data["MutationRate"] = mutationRate;
+		data["MutationAdjustment"] = mutationAdjustment;
+		data["MaxTicks"] = maxTicks;
+		data["TargetScore"] = targetScore;
+		data["StagnationTicks"] = stagnationTicks;
+		data["HiddenLayers"] = hiddenLayers;
+		data["NodesPerLayer"] = nodesPerLayer;
+		data["Neat"] = neat;
+		data["AddNodeRate"] = addNodeRate;
+		data["AddConnectionRate"] = addConnectionRate;
+		data["RemoveConnectionRate"] = removeConnectionRate;
+		data["CompatibilityThreshold"] = compatibilityThreshold;
+		data["Optimizer"] = optimizer;
+		data["Sigma"] = sigma;
+		data["LearningRate"] = learningRate;
+		data["Activation"] = activation;
+		data["InferenceMode"] = inferenceMode;
+		data["ValidateQuantizedInference"] = validateQuantizedInference;
+		data["CompiledNetworks"] = compiledNetworks;
+		data["AnalyticAdvance"] = analyticAdvance;
+		data["Profile"] = profile;
+		data["LogLevel"] = logLevel;
+		data["LogCountersOnly"] = logCountersOnly;
+		data["Seed"] = seed;
+		data["CourseSeed"] = courseSeed;
+		data["FitnessCache"] = fitnessCache;
+		data["Threads"] = threads;
+		data["Workers"] = workers;
+		data["WorkerPopulation"] = workerPopulation;
+		data["WorkerResults"] = workerResults;
+		data["WorkerIndex"] = workerIndex;
+		data["WorkerCount"] = workerCount;
+		data["CoordinatorPort"] = coordinatorPort;
+		data["Coordinator"] = coordinator;
+		data["BatchSize"] = batchSize;
+		data["EpochDirectory"] = epochDirectory;
+		data["Headless"] = headless;
+		data["ShowTrainingStats"] = showTrainingStats;
+		data["FastTransitions"] = fastTransitions;
+		data["RecordReplays"] = recordReplays;
+		data["ReplayFile"] = replayFile;
+		data["Replay"] = replayEpoch;
+		data["Top"] = top;
+		data["ReplaySpeed"] = replaySpeed;
+		data["MaxGenerations"] = maxGenerations;
+		data["Sweep"] = sweepFile;
+		data["Benchmark"] = benchmarkFile;
+		data["BenchmarkEpoch"] = benchmarkEpoch;
+		data["Throughput"] = throughputFile;
+		data["StatsFile"] = statsFile;
+		return data;
+	}
+
+	void RunConfig::FromJson(const nlohmann::json& data)
+	{
+		//Merge onto the current values, so files and overrides only need the keys they change
+		nlohmann::json merged = ToJson();
+		for (const auto& item : data.items())
+		{
+			if (!merged.contains(item.key()))
+			{
+				std::cout << "Unknown config key " << item.key() << std::endl;
+				continue;
+			}
+			merged[item.key()] = item.value();
+		}
+
+		try
+		{
+			populationSize = merged["PopulationSize"];
+			eliteSize = merged["EliteSize"];
+			matingPoolSize = merged["MatingPoolSize"];
+			crossoverRate = merged["CrossoverRate"];
+			mutationRate = merged["MutationRate"];
+			mutationAdjustment = merged["MutationAdjustment"];
+			maxTicks = merged["MaxTicks"];
+			targetScore = merged["TargetScore"];
+			stagnationTicks = merged["StagnationTicks"];
+			hiddenLayers = merged["HiddenLayers"];
+			nodesPerLayer = merged["NodesPerLayer"];
+			neat = merged["Neat"];
+			addNodeRate = merged["AddNodeRate"];
+			addConnectionRate = merged["AddConnectionRate"];
+			removeConnectionRate = merged["RemoveConnectionRate"];
+			compatibilityThreshold = merged["CompatibilityThreshold"];
+			optimizer = merged["Optimizer"];
+			sigma = merged["Sigma"];
+			learningRate = merged["LearningRate"];
+			activation = merged["Activation"];
+			inferenceMode = merged["InferenceMode"];
+			validateQuantizedInference = merged["ValidateQuantizedInference"];
+			compiledNetworks = merged["CompiledNetworks"];
+			analyticAdvance = merged["AnalyticAdvance"];
+			profile = merged["Profile"];
+			logLevel = merged["LogLevel"];
+			logCountersOnly = merged["LogCountersOnly"];
+			seed = merged["Seed"];
+			courseSeed = merged["CourseSeed"];
+			fitnessCache = merged["FitnessCache"];
+			threads = merged["Threads"];
+			workers = merged["Workers"];
+			workerPopulation = merged["WorkerPopulation"];
+			workerResults = merged["WorkerResults"];
+			workerIndex = merged["WorkerIndex"];
+			workerCount = merged["WorkerCount"];
+			coordinatorPort = merged["CoordinatorPort"];
+			coordinator = merged["Coordinator"];
+			batchSize = merged["BatchSize"];
+			epochDirectory = merged["EpochDirectory"];
+			headless = merged["Headless"];
+			showTrainingStats = merged["ShowTrainingStats"];
+			fastTransitions = merged["FastTransitions"];
+			recordReplays = merged["RecordReplays"];
+			replayFile = merged["ReplayFile"];
+			//--replay 12 arrives as a number
+			replayEpoch = merged["Replay"].is_string() ? merged["Replay"].get<std::string>() : merged["Replay"].dump();
+			top = merged["Top"];
+			replaySpeed = merged["ReplaySpeed"];
+			maxGenerations = merged["MaxGenerations"];
+			sweepFile = merged["Sweep"];
+			benchmarkFile = merged["Benchmark"];
+			benchmarkEpoch = merged["BenchmarkEpoch"];
+			throughputFile = merged["Throughput"];
+			statsFile = merged["StatsFile"];
+		}
+		catch (const nlohmann::json::exception& e)
+		{
+			std::cout << "Error Reading Config: " << e.what() << std::endl;
+		}
+
+		//Keep the values the genetic algorithm relies on sensible
+		if (populationSize < 2)
+			populationSize = 2;
+		if (eliteSize > populationSize)
+			eliteSize = populationSize;
+		if (eliteSize < 0)
+			eliteSize = 0;
+		//Crossover needs two different parents
+		if (matingPoolSize < 2)
+			matingPoolSize = 2;
+		if (hiddenLayers < 0)
+			hiddenLayers = 0;
+		if (nodesPerLayer < 1)
+			nodesPerLayer = 1;
+		if (compatibilityThreshold <= 0)
+			compatibilityThreshold = NEAT_COMPATIBILITY_THRESHOLD;
+		if (optimizer != "GA" && optimizer != "ES" && optimizer != "CMA-ES")
+		{
+			std::cout << "Error Reading Config: unknown optimizer " << optimizer << ", using GA" << std::endl;
+			optimizer = "GA";
+		}
+		if (sigma <= 0)
+			sigma = OPTIMIZER_SIGMA;
+		if (learningRate <= 0)
+			learningRate = ES_LEARNING_RATE;
+		if (Activation::ParseType(activation) < 0)
+		{
+			std::cout << "Error Reading Config: unknown activation " << activation << ", using Tanh" << std::endl;
+			activation = "Tanh";
+		}
+		//The int8 path requantizes the hidden values assuming they stay within [-1, 1]
+		if (activation == "ReLU" && inferenceMode == INFERENCE_INT8)
+		{
+			std::cout << "ReLU activations are unbounded, using float inference" << std::endl;
+			inferenceMode = INFERENCE_FLOAT;
+		}
+		if (threads < 0)
+			threads = 0;
+		if (workers < 0)
+			workers = 0;
+		if (workerCount < 1)
+			workerCount = 1;
+		if (workerIndex < 0 || workerIndex >= workerCount)
+			workerIndex = 0;
+		if (coordinatorPort < 0 || coordinatorPort > 65535)
+			coordinatorPort = 0;
+		if (batchSize < 1)
+			batchSize = 1;
+		if (replaySpeed <= 0)
+			replaySpeed = 1.0f;
+		if (top < 1)
+			top = 1;
+		if (!epochDirectory.empty() && epochDirectory.back() != '/' && epochDirectory.back() != '\\')
+			epochDirectory += "/";
+	}
+}
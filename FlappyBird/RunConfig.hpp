@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+
+#include "DEFINITIONS.hpp"
+
+//library for json files, namepspace definition
+#include "nlohmann/json.hpp"
+
+namespace Sonar
+{
+	//Training hyperparameters and topology, loaded at startup instead of being compiled in.
+	//The DEFINITIONS.hpp values are only the defaults
+	struct RunConfig
+	{
+		int populationSize = POPULATION_SIZE;
+		int eliteSize = ELITE_SIZE;
+		int matingPoolSize = MATING_POOL_SIZE;
+		float crossoverRate = CROSSOVER_RATE;
+		int mutationRate = MUTATION_RATE;
+		float mutationAdjustment = MUTATION_ADJUSTMENT;
+
+		//A generation ends early after this many ticks, once the score reaches the target,
+		//or when nobody has passed a pipe for the stagnation window
+		int maxTicks = MAX_GENERATION_TICKS;
+		int targetScore = TARGET_SCORE;
+		int stagnationTicks = STAGNATION_TICKS;
+
+		int hiddenLayers = HIDDEN_LAYERS;
+		int nodesPerLayer = NODES_PER_LAYER;
+
+		//Evolves the topology too, starting from the inputs wired straight to the output. The layer settings are ignored
+		bool neat = false;
+		int addNodeRate = NEAT_ADD_NODE_RATE;
+		int addConnectionRate = NEAT_ADD_CONNECTION_RATE;
+		int removeConnectionRate = NEAT_REMOVE_CONNECTION_RATE;
+		float compatibilityThreshold = NEAT_COMPATIBILITY_THRESHOLD;
+
+		//Search over the flat weight vector instead of the genetic algorithm: GA, ES or CMA-ES. Not used with NEAT
+		std::string optimizer = "GA";
+		float sigma = OPTIMIZER_SIGMA;
+		//Only used by ES
+		float learningRate = ES_LEARNING_RATE;
+
+		//Hidden node activation: Tanh, or the faster TanhTable, TanhRational and HardTanh approximations, or ReLU
+		std::string activation = ACTIVATION;
+
+		int inferenceMode = INFERENCE_MODE;
+		bool validateQuantizedInference = VALIDATE_QUANTIZED_INFERENCE;
+		bool compiledNetworks = COMPILED_NETWORKS;
+		//Only applies to float inference
+		bool analyticAdvance = ANALYTIC_ADVANCE;
+
+		//Records per phase timings and writes a trace and summary into the epoch directory every generation
+		bool profile = false;
+
+		//Lowest EventLog level written to the console: Debug (every tap), Info, Warning, Error or Off
+		std::string logLevel = "Info";
+		//Only counts events, nothing is queued or written
+		bool logCountersOnly = false;
+
+		//Seeds rand() for the genetic algorithm and the course of each generation. 0 seeds from the clock
+		unsigned int seed = 0;
+		//Every generation flies the pipe course from this seed. 0 draws a new course each generation
+		unsigned int courseSeed = COURSE_SEED;
+		//Genomes that already flew the course take their old score instead of flying again. Only runs with a non-zero
+		//CourseSeed, so the default of 0 leaves it idle
+		bool fitnessCache = true;
+		//Threads the per bird work is split over. 0 uses every core
+		int threads = 1;
+		//Worker processes each generation is flown in. 0 flies it in this process
+		int workers = 0;
+		//Set on the worker processes: the population file to map, the results file to write, and which share to fly
+		std::string workerPopulation = "";
+		std::string workerResults = "";
+		int workerIndex = 0;
+		int workerCount = 1;
+		//Listens on this port and flies each generation on the workers that connect to it. 0 doesn't listen
+		int coordinatorPort = 0;
+		//Runs as a worker for the coordinator at this host:port instead of training
+		std::string coordinator = "";
+		//Genomes sent to a connected worker at a time
+		int batchSize = 25;
+
+		//Where the epoch files are read from and written to. Give parallel runs separate directories
+		std::string epochDirectory = "epochs/";
+
+		//Trains without drawing, the window stays hidden
+		bool headless = false;
+		//Writes each generation's best flight to replayN.json in the epoch directory
+		bool recordReplays = true;
+		//Plays back this replay file instead of training
+		std::string replayFile = "";
+		//Flies the best birds of this epoch, a file or a generation number in the epoch directory, instead of training.
+		//Only the top ones are loaded, nothing is evolved or written
+		std::string replayEpoch = "";
+		int top = 1;
+		//Ticks played per frame by the replay viewer, the arrow keys change it while watching
+		float replaySpeed = 1.0f;
+		//Draws the generation, live birds, throughput and a score curve over the game
+		bool showTrainingStats = true;
+		//Training starts the next generation as soon as one ends, without the death flash or the game over screen
+		bool fastTransitions = true;
+		//Closes the game once this many generations exist in the epoch directory. 0 trains forever
+		int maxGenerations = 0;
+		//Runs the hyperparameter sweep described by this file instead of training
+		std::string sweepFile = "";
+		//Runs the micro-benchmarks and writes the results to this json file instead of training
+		std::string benchmarkFile = "";
+		//Population the benchmark fixtures are built from. Empty uses the newest epoch in the epoch directory
+		std::string benchmarkEpoch = "";
+		//Runs headless training at 1, 2, 4... threads and writes the throughput of each to this json file
+		std::string throughputFile = "";
+		//Written when the game closes, generations and bird ticks trained, wall time and memory use
+		std::string statsFile = "";
+
+		//Path of this executable, from the command line. Not part of the json, workers are started from it
+		std::string executable = "";
+
+		//Reads the config file (--config <file>, config.json by default), then applies the command line overrides.
+		//Overrides are written as --population-size 300, matching the PopulationSize key of the file
+		void Load(int argc, char** argv);
+
+		bool LoadFile(const std::string& fileName);
+		void ApplyArguments(int argc, char** argv);
+
+		nlohmann::json ToJson() const;
+		void FromJson(const nlohmann::json& data);
+	};
+}
@@ -4,6 +4,7 @@
 #include "SplashState.hpp"
 #include "DEFINITIONS.hpp"
 #include "MainMenuState.hpp"
+#include "GameState.hpp"
 
 #include <iostream>
 
@@ -19,6 +20,29 @@ namespace Sonar
 		this->_data->assets.LoadTexture("Splash State Background", SPLASH_SCENE_BACKGROUND_FILEPATH);
 
 		_background.setTexture(this->_data->assets.GetTexture("Splash State Background"));
+
+		//Everything the later states load, read while the splash is showing
+		this->_data->assets.Preload({
+			{ "Main Menu Background", MAIN_MENU_BACKGROUND_FILEPATH },
+			{ "Game Title", GAME_TITLE_FILEPATH },
+			{ "Play Button", PLAY_BUTTON_FILEPATH },
+			{ "Game Background", GAME_BACKGROUND_FILEPATH },
+			{ "Pipe Up", PIPE_UP_FILEPATH },
+			{ "Pipe Down", PIPE_DOWN_FILEPATH },
+			{ "Land", LAND_FILEPATH },
+			{ "Bird Frame 1", BIRD_FRAME_1_FILEPATH },
+			{ "Bird Frame 2", BIRD_FRAME_2_FILEPATH },
+			{ "Bird Frame 3", BIRD_FRAME_3_FILEPATH },
+			{ "Bird Frame 4", BIRD_FRAME_4_FILEPATH },
+			{ "Scoring Pipe", SCORING_PIPE_FILEPATH },
+			{ "Game Over Background", GAME_OVER_BACKGROUND_FILEPATH },
+			{ "Game Over Title", GAME_OVER_TITLE_FILEPATH },
+			{ "Game Over Body", GAME_OVER_BODY_FILEPATH },
+			{ "Bronze Medal", BRONZE_MEDAL_FILEPATH },
+			{ "Silver Medal", SILVER_MEDAL_FILEPATH },
+			{ "Gold Medal", GOLD_MEDAL_FILEPATH },
+			{ "Platinum Medal", PLATINUM_MEDAL_FILEPATH }
+		});
 	}
 
 	void SplashState::HandleInput()
@@ -36,10 +60,15 @@ namespace Sonar
 
 	void SplashState::Update(float dt)
 	{
-		if (this->_clock.getElapsedTime().asSeconds() > SPLASH_STATE_SHOW_TIME)
+		//Nobody sees the splash of a hidden window either, worker processes start flying straight away
+		if (this->_data->config.headless || this->_clock.getElapsedTime().asSeconds() > SPLASH_STATE_SHOW_TIME)
 		{
-			// Switch To Main Menu
-			this->_data->machine.AddState(new MainMenuState(_data), true);
+			//Nobody can press play on a hidden window, headless runs go straight to training
+			if (this->_data->config.headless)
+				this->_data->machine.AddState(new GameState(_data), true);
+			else
+				// Switch To Main Menu
+				this->_data->machine.AddState(new MainMenuState(_data), true);
 		}
 	}
 
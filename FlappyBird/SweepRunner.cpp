@@ -0,0 +1,298 @@
+#include "SweepRunner.hpp"
+#include "Process.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace Sonar
+{
+	SweepRunner::SweepRunner(const std::string& executable, const RunConfig& baseConfig) : _executable(executable), _baseConfig(baseConfig)
+	{
+		//Children must not start sweeps or benchmarks of their own
+		_baseConfig.sweepFile = "";
+		_baseConfig.benchmarkFile = "";
+		_baseConfig.throughputFile = "";
+	}
+
+	bool SweepRunner::Run(const std::string& sweepFileName)
+	{
+		std::ifstream sweepFile(sweepFileName);
+		if (!sweepFile.good())
+		{
+			std::cout << "Error Loading Sweep " << sweepFileName << std::endl;
+			return false;
+		}
+		nlohmann::json sweep = nlohmann::json::parse(sweepFile, nullptr, false);
+		if (sweep.is_discarded() || !sweep.contains("Parameters"))
+		{
+			std::cout << "Error Reading Sweep " << sweepFileName << std::endl;
+			return false;
+		}
+
+		_outputDirectory = sweep.value("OutputDirectory", _outputDirectory);
+		if (!_outputDirectory.empty() && _outputDirectory.back() != '/')
+			_outputDirectory += "/";
+		_generations = sweep.value("Generations", _generations);
+		_jobCount = sweep.value("Jobs", 0);
+		_earlyStopGeneration = sweep.value("EarlyStopGeneration", _earlyStopGeneration);
+		_earlyStopFraction = sweep.value("EarlyStopFraction", _earlyStopFraction);
+		if (sweep.contains("Base"))
+			_baseConfig.FromJson(sweep["Base"]);
+
+		if (sweep.value("Mode", std::string("grid")) == "random")
+			GenerateRandom(sweep["Parameters"], sweep.value("Samples", 10), sweep.value("Seed", (unsigned int)time(NULL)));
+		else
+			GenerateGrid(sweep["Parameters"]);
+
+		if (_jobCount <= 0)
+			_jobCount = std::max(1, (int)std::thread::hardware_concurrency());
+		std::cout << "Sweeping " << _jobs.size() << " configurations on " << _jobCount << " cores" << std::endl;
+
+		std::vector<std::thread> workers;
+		for (int i = 0; i < _jobCount; i++)
+		{
+			workers.push_back(std::thread(&SweepRunner::Worker, this));
+		}
+		while (CheckProgress())
+		{
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+		}
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		WriteSummary();
+		return true;
+	}
+
+	void SweepRunner::GenerateGrid(const nlohmann::json& parameters)
+	{
+		//Cartesian product of every value list
+		std::vector<nlohmann::json> combinations(1, nlohmann::json::object());
+		for (const auto& parameter : parameters.items())
+		{
+			std::vector<nlohmann::json> expanded;
+			for (const auto& combination : combinations)
+			{
+				if (!parameter.value().is_array())
+				{
+					nlohmann::json next = combination;
+					next[parameter.key()] = parameter.value();
+					expanded.push_back(next);
+					continue;
+				}
+				for (const auto& value : parameter.value())
+				{
+					nlohmann::json next = combination;
+					next[parameter.key()] = value;
+					expanded.push_back(next);
+				}
+			}
+			combinations = expanded;
+		}
+		for (const auto& combination : combinations)
+		{
+			AddJob(combination);
+		}
+	}
+
+	void SweepRunner::GenerateRandom(const nlohmann::json& parameters, int samples, unsigned int seed)
+	{
+		std::mt19937 random(seed);
+		for (int i = 0; i < samples; i++)
+		{
+			nlohmann::json combination = nlohmann::json::object();
+			for (const auto& parameter : parameters.items())
+			{
+				const nlohmann::json& space = parameter.value();
+				//Lists are sampled uniformly, {"Min", "Max"} ranges are integer or real depending on the bounds
+				if (space.is_array() && !space.empty())
+				{
+					std::uniform_int_distribution<int> pick(0, (int)space.size() - 1);
+					combination[parameter.key()] = space.at(pick(random));
+				}
+				else if (space.is_object() && space.contains("Min") && space.contains("Max"))
+				{
+					if (space["Min"].is_number_integer() && space["Max"].is_number_integer())
+					{
+						std::uniform_int_distribution<int> range(space["Min"].get<int>(), space["Max"].get<int>());
+						combination[parameter.key()] = range(random);
+					}
+					else
+					{
+						std::uniform_real_distribution<float> range(space["Min"].get<float>(), space["Max"].get<float>());
+						combination[parameter.key()] = range(random);
+					}
+				}
+				else
+					combination[parameter.key()] = space;
+			}
+			AddJob(combination);
+		}
+	}
+
+	void SweepRunner::AddJob(const nlohmann::json& parameters)
+	{
+		SweepJob job;
+		job.id = (int)_jobs.size();
+		job.parameters = parameters;
+		job.directory = _outputDirectory + "run" + std::to_string(job.id) + "/";
+
+		//Each run trains headless in its own epoch directory
+		RunConfig config = _baseConfig;
+		config.FromJson(parameters);
+		config.headless = true;
+		config.maxGenerations = _generations;
+		config.epochDirectory = job.directory + "epochs/";
+		CreateDirectories(config.epochDirectory);
+
+		std::ofstream configFile(job.directory + "config.json");
+		configFile << std::setw(4) << config.ToJson();
+
+		_jobs.push_back(job);
+	}
+
+	void SweepRunner::Worker()
+	{
+		while (true)
+		{
+			SweepJob* job = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(_jobMutex);
+				if (_nextJob >= _jobs.size())
+					return;
+				job = &_jobs.at(_nextJob);
+				job->state = eRunning;
+				_nextJob++;
+			}
+
+			int exitCode = RunProcess(_executable, { "--config", job->directory + "config.json" });
+
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			job->exitCode = exitCode;
+			job->state = eFinished;
+		}
+	}
+
+	bool SweepRunner::CheckProgress()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+
+		std::vector<std::vector<int>> curves;
+		bool running = false;
+		for (const auto& job : _jobs)
+		{
+			curves.push_back(ReadProgress(job));
+			if (job.state != eFinished)
+				running = true;
+		}
+
+		for (auto& job : _jobs)
+		{
+			const std::vector<int>& curve = curves.at(job.id);
+			int generation = (int)curve.size() - 1;
+			if (job.state != eRunning || job.stoppedEarly || generation < _earlyStopGeneration)
+				continue;
+
+			//Median of every run that got this far
+			std::vector<int> scores;
+			for (const auto& other : curves)
+			{
+				if ((int)other.size() > generation)
+					scores.push_back(other.at(generation));
+			}
+			if (scores.size() < 3)
+				continue;
+			std::nth_element(scores.begin(), scores.begin() + scores.size() / 2, scores.end());
+			float median = (float)scores.at(scores.size() / 2);
+
+			if (curve.at(generation) < median * _earlyStopFraction)
+			{
+				//The child checks for this file at the end of every generation
+				std::ofstream stopFile(job.directory + "epochs/stop");
+				stopFile << generation;
+				job.stoppedEarly = true;
+				std::cout << "Stopping run " << job.id << " at generation " << generation << " (best " << curve.at(generation) << ", median " << median << ")" << std::endl;
+			}
+		}
+		return running;
+	}
+
+	std::vector<int> SweepRunner::ReadProgress(const SweepJob& job) const
+	{
+		std::vector<int> curve;
+		std::ifstream progressFile(job.directory + "epochs/progress.csv");
+		std::string line;
+		std::getline(progressFile, line); //Header
+		int bestSoFar = 0;
+		while (std::getline(progressFile, line))
+		{
+			std::istringstream columns(line);
+			std::string generation, best;
+			if (!std::getline(columns, generation, ',') || !std::getline(columns, best, ','))
+				break;
+			bestSoFar = std::max(bestSoFar, std::atoi(best.c_str()));
+			curve.push_back(bestSoFar);
+		}
+		return curve;
+	}
+
+	void SweepRunner::WriteSummary()
+	{
+		std::vector<std::string> keys;
+		for (const auto& job : _jobs)
+		{
+			for (const auto& parameter : job.parameters.items())
+			{
+				if (std::find(keys.begin(), keys.end(), parameter.key()) == keys.end())
+					keys.push_back(parameter.key());
+			}
+		}
+
+		//Best runs first
+		std::vector<std::pair<int, int>> ranking;
+		for (const auto& job : _jobs)
+		{
+			std::vector<int> curve = ReadProgress(job);
+			ranking.push_back(std::make_pair(curve.empty() ? 0 : curve.back(), job.id));
+		}
+		std::sort(ranking.begin(), ranking.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first > b.first; });
+
+		std::ofstream summaryFile(_outputDirectory + "summary.csv");
+		summaryFile << "Run";
+		std::cout << std::setw(6) << "Run";
+		for (const auto& key : keys)
+		{
+			summaryFile << "," << key;
+			std::cout << std::setw(20) << key;
+		}
+		summaryFile << ",Generations,BestScore,StoppedEarly,ExitCode" << std::endl;
+		std::cout << std::setw(12) << "Generations" << std::setw(10) << "Best" << std::setw(9) << "Stopped" << std::endl;
+
+		for (const auto& entry : ranking)
+		{
+			const SweepJob& job = _jobs.at(entry.second);
+			int generations = (int)ReadProgress(job).size();
+
+			summaryFile << job.id;
+			std::cout << std::setw(6) << job.id;
+			for (const auto& key : keys)
+			{
+				std::string value = job.parameters.contains(key) ? job.parameters[key].dump() : "";
+				summaryFile << "," << value;
+				std::cout << std::setw(20) << value;
+			}
+			summaryFile << "," << generations << "," << entry.first << "," << (job.stoppedEarly ? 1 : 0) << "," << job.exitCode << std::endl;
+			std::cout << std::setw(12) << generations << std::setw(10) << entry.first << std::setw(9) << (job.stoppedEarly ? "yes" : "no") << std::endl;
+		}
+		std::cout << "Sweep summary written to " << _outputDirectory << "summary.csv" << std::endl;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "RunConfig.hpp"
+
+namespace Sonar
+{
+	//Runs a grid or random hyperparameter search as headless training processes spread over the local cores.
+	//Runs that fall below the median progress curve are stopped early, and one summary table is written at the end
+	class SweepRunner
+	{
+	public:
+		SweepRunner(const std::string& executable, const RunConfig& baseConfig);
+
+		//Returns false if the sweep file can't be read
+		bool Run(const std::string& sweepFileName);
+
+	private:
+		enum JobStates
+		{
+			ePending,
+			eRunning,
+			eFinished
+		};
+
+		struct SweepJob
+		{
+			int id = 0;
+			nlohmann::json parameters;
+			std::string directory;
+			int state = ePending;
+			bool stoppedEarly = false;
+			int exitCode = 0;
+		};
+
+		void GenerateGrid(const nlohmann::json& parameters);
+		void GenerateRandom(const nlohmann::json& parameters, int samples, unsigned int seed);
+		void AddJob(const nlohmann::json& parameters);
+
+		//Pops jobs off the queue until it is empty
+		void Worker();
+		//Stops the running jobs that fall below the median curve. Returns false once every job has finished
+		bool CheckProgress();
+		//Best score so far at each generation of a job
+		std::vector<int> ReadProgress(const SweepJob& job) const;
+		void WriteSummary();
+
+		std::string _executable;
+		RunConfig _baseConfig;
+
+		std::string _outputDirectory = "sweeps/";
+		int _generations = 20;
+		int _jobCount = 0;
+		int _earlyStopGeneration = 5;
+		float _earlyStopFraction = 0.5f;
+
+		std::vector<SweepJob> _jobs;
+		unsigned int _nextJob = 0;
+		std::mutex _jobMutex;
+	};
+}
@@ -0,0 +1,137 @@
+#include "ThroughputBenchmark.hpp"
+#include "Process.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#define THROUGHPUT_SEED 12345
+#define THROUGHPUT_GENERATIONS 5
+
+namespace Sonar
+{
+	ThroughputBenchmark::ThroughputBenchmark(const std::string& executable, const RunConfig& baseConfig) : _executable(executable), _baseConfig(baseConfig)
+	{
+		_baseConfig.throughputFile = "";
+		_baseConfig.sweepFile = "";
+		_baseConfig.benchmarkFile = "";
+		//Every thread count has to train the exact same run
+		if (_baseConfig.seed == 0)
+			_baseConfig.seed = THROUGHPUT_SEED;
+		if (_baseConfig.maxGenerations <= 0)
+			_baseConfig.maxGenerations = THROUGHPUT_GENERATIONS;
+	}
+
+	bool ThroughputBenchmark::Run(const std::string& outputFileName)
+	{
+		std::cout << "Training " << _baseConfig.maxGenerations << " generations with seed " << _baseConfig.seed << std::endl;
+		std::cout << std::setw(8) << "Threads" << std::setw(18) << "Bird ticks/s" << std::setw(16) << "Generations/s"
+			<< std::setw(16) << "Peak MB" << std::setw(20) << "Allocations/gen" << std::endl;
+
+		nlohmann::json results = nlohmann::json::array();
+		long long expectedBirdTicks = -1;
+		for (int threads : GetThreadCounts())
+		{
+			nlohmann::json stats = RunTraining(threads);
+			if (stats.is_null())
+			{
+				std::cout << std::setw(8) << threads << "  failed" << std::endl;
+				continue;
+			}
+
+			double seconds = std::max(stats.value("Seconds", 0.0), 1e-9);
+			long long birdTicks = stats.value("BirdTicks", 0LL);
+			int generations = std::max(stats.value("Generations", 0), 1);
+
+			nlohmann::json result;
+			result["Threads"] = threads;
+			result["Seconds"] = seconds;
+			result["Generations"] = stats.value("Generations", 0);
+			result["BirdTicks"] = birdTicks;
+			result["BirdTicksPerSecond"] = birdTicks / seconds;
+			result["GenerationsPerSecond"] = stats.value("Generations", 0) / seconds;
+			result["PeakMemory"] = stats.value("PeakMemory", 0LL);
+			result["AllocationsPerGeneration"] = stats.value("Allocations", 0LL) / generations;
+			results.push_back(result);
+
+			std::ostringstream line;
+			line << std::fixed << std::setprecision(2) << std::setw(8) << threads
+				<< std::setw(18) << result["BirdTicksPerSecond"].get<double>()
+				<< std::setw(16) << result["GenerationsPerSecond"].get<double>()
+				<< std::setw(16) << result["PeakMemory"].get<long long>() / (1024.0 * 1024.0)
+				<< std::setw(20) << result["AllocationsPerGeneration"].get<long long>();
+			std::cout << line.str() << std::endl;
+
+			//The threads only split per bird work, so the simulation itself mustn't change
+			if (expectedBirdTicks >= 0 && birdTicks != expectedBirdTicks)
+				std::cout << "Warning: " << threads << " threads simulated " << birdTicks << " bird ticks, expected " << expectedBirdTicks << std::endl;
+			expectedBirdTicks = birdTicks;
+		}
+
+		nlohmann::json output;
+		output["Seed"] = _baseConfig.seed;
+		output["Generations"] = _baseConfig.maxGenerations;
+		output["PopulationSize"] = _baseConfig.populationSize;
+		output["Results"] = results;
+
+		std::ofstream outputFile(outputFileName);
+		if (!outputFile.good())
+		{
+			std::cout << "Error Writing Throughput Results " << outputFileName << std::endl;
+			return false;
+		}
+		outputFile << std::setw(4) << output << std::endl;
+		std::cout << "Throughput results written to " << outputFileName << std::endl;
+		return !results.empty();
+	}
+
+	nlohmann::json ThroughputBenchmark::RunTraining(int threads)
+	{
+		std::string directory = _outputDirectory + "threads" + std::to_string(threads) + "/";
+
+		RunConfig config = _baseConfig;
+		config.headless = true;
+		config.threads = threads;
+		config.epochDirectory = directory + "epochs/";
+		config.statsFile = directory + "stats.json";
+
+		//Start from generation 0 every time, leftovers from an earlier benchmark would be continued
+		for (int generation = 0; RemoveFile(config.epochDirectory + "epoch" + std::to_string(generation) + ".json"); generation++);
+		RemoveFile(config.epochDirectory + "progress.csv");
+		for (int generation = 0; RemoveFile(config.epochDirectory + "replay" + std::to_string(generation) + ".json"); generation++);
+		RemoveFile(config.epochDirectory + "diversity.ndjson");
+		RemoveFile(config.epochDirectory + "stop");
+		RemoveFile(config.statsFile);
+		CreateDirectories(config.epochDirectory);
+
+		std::ofstream configFile(directory + "config.json");
+		configFile << std::setw(4) << config.ToJson();
+		configFile.close();
+
+		RunProcess(_executable, { "--config", directory + "config.json" });
+
+		std::ifstream statsFile(config.statsFile);
+		if (!statsFile.good())
+			return nullptr;
+		nlohmann::json stats = nlohmann::json::parse(statsFile, nullptr, false);
+		if (stats.is_discarded())
+			return nullptr;
+		return stats;
+	}
+
+	std::vector<int> ThroughputBenchmark::GetThreadCounts() const
+	{
+		//Powers of two up to the thread setting, or the core count when it's left at 0 or 1
+		int maxThreads = _baseConfig.threads > 1 ? _baseConfig.threads : std::max(1, (int)std::thread::hardware_concurrency());
+		std::vector<int> threadCounts;
+		for (int threads = 1; threads < maxThreads; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+		return threadCounts;
+	}
+}
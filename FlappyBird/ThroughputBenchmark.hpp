@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RunConfig.hpp"
+
+namespace Sonar
+{
+	//End to end training throughput. Trains the same seeded run from scratch as a headless child process at
+	//1, 2, 4... threads, and reports bird ticks and generations per second, peak memory and allocations for each
+	class ThroughputBenchmark
+	{
+	public:
+		ThroughputBenchmark(const std::string& executable, const RunConfig& baseConfig);
+
+		bool Run(const std::string& outputFileName);
+
+	private:
+		//Trains in a clean directory and returns the child's stats, null if it didn't write any
+		nlohmann::json RunTraining(int threads);
+		std::vector<int> GetThreadCounts() const;
+
+		std::string _executable;
+		RunConfig _baseConfig;
+
+		std::string _outputDirectory = "throughput/";
+	};
+}
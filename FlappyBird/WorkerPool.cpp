@@ -0,0 +1,84 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+//Loops shorter than this per thread aren't worth waking the workers for
+#define WORKER_POOL_MIN_SHARE 16
+
+namespace Sonar
+{
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_jobReady.notify_all();
+		for (auto& thread : _threads)
+		{
+			thread.join();
+		}
+	}
+
+	void WorkerPool::Start(int threadCount)
+	{
+		if (threadCount <= 0)
+			threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		for (int i = (int)_threads.size() + 1; i < threadCount; i++)
+		{
+			_threads.push_back(std::thread(&WorkerPool::WorkerLoop, this, i));
+		}
+	}
+
+	void WorkerPool::ParallelFor(int count, const std::function<void(int begin, int end)>& function)
+	{
+		int threadCount = GetThreadCount();
+		if (threadCount == 1 || count < WORKER_POOL_MIN_SHARE * threadCount)
+		{
+			function(0, count);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_job = &function;
+			_count = count;
+			_remaining = threadCount - 1;
+			_jobNumber++;
+		}
+		_jobReady.notify_all();
+
+		//The calling thread does the first share
+		function(0, count / threadCount);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_jobDone.wait(lock, [this]() { return _remaining == 0; });
+		_job = nullptr;
+	}
+
+	void WorkerPool::WorkerLoop(int index)
+	{
+		int lastJob = 0;
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_jobReady.wait(lock, [&]() { return _stopping || _jobNumber != lastJob; });
+			if (_stopping)
+				return;
+			lastJob = _jobNumber;
+
+			const std::function<void(int begin, int end)>* job = _job;
+			int threadCount = GetThreadCount();
+			int begin = (int)((long long)_count * index / threadCount);
+			int end = (int)((long long)_count * (index + 1) / threadCount);
+
+			lock.unlock();
+			(*job)(begin, end);
+			lock.lock();
+
+			_remaining--;
+			if (_remaining == 0)
+				_jobDone.notify_one();
+		}
+	}
+}
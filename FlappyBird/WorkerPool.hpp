@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sonar
+{
+	//Fixed set of threads that split per bird loops between them. The calling thread takes a share of every loop,
+	//so a pool of one thread runs everything inline
+	class WorkerPool
+	{
+	public:
+		WorkerPool() { }
+		~WorkerPool();
+
+		//0 uses every core
+		void Start(int threadCount);
+		int GetThreadCount() const { return (int)_threads.size() + 1; }
+
+		//Splits [0, count) into one contiguous range per thread and blocks until every range is done.
+		//function must only touch state owned by the indices it is given
+		void ParallelFor(int count, const std::function<void(int begin, int end)>& function);
+
+	private:
+		void WorkerLoop(int index);
+
+		std::vector<std::thread> _threads;
+		std::mutex _mutex;
+		std::condition_variable _jobReady;
+		std::condition_variable _jobDone;
+
+		const std::function<void(int begin, int end)>* _job = nullptr;
+		int _count = 0;
+		int _jobNumber = 0;
+		int _remaining = 0;
+		bool _stopping = false;
+	};
+}
@@ -1,9 +1,33 @@
 #include "Game.hpp"
+#include "SweepRunner.hpp"
+#include "Benchmark.hpp"
+#include "ThroughputBenchmark.hpp"
 #include "DEFINITIONS.hpp"
 
-int main()
+int main(int argc, char** argv)
 {
-	Sonar::Game(SCREEN_WIDTH, SCREEN_HEIGHT, "Flappy Bird");
+	Sonar::RunConfig config;
+	config.Load(argc, argv);
+
+	if (!config.sweepFile.empty())
+	{
+		Sonar::SweepRunner sweep(argv[0], config);
+		return sweep.Run(config.sweepFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (!config.throughputFile.empty())
+	{
+		Sonar::ThroughputBenchmark throughput(argv[0], config);
+		return throughput.Run(config.throughputFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (!config.benchmarkFile.empty())
+	{
+		Sonar::Benchmark benchmark(config);
+		return benchmark.Run(config.benchmarkFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	Sonar::Game(SCREEN_WIDTH, SCREEN_HEIGHT, "Flappy Bird", config);
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file